@@ -0,0 +1,152 @@
+/* Name: main.c
+ * Project: cdc-acm example
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+This example implements a virtual serial port with libs-device/cdcacm.c. All
+characters received are echoed back, except for two commands which run a
+throughput benchmark:
+
+'I' ... The device sends data as fast as the host accepts it for one second
+        and then prints the number of bytes per second.
+'O' ... The device counts the bytes it receives during one second, starting
+        with the next byte, and then prints the number of bytes per second.
+        Send a file which does not contain 'I' or 'O' characters, e.g.
+        head -c 20000 /dev/zero >/dev/ttyACM0
+
+Time is measured with Timer 1 at F_CPU/1024.
+*/
+
+#include <avr/io.h>
+#include <avr/wdt.h>
+#include <avr/interrupt.h>  /* for sei() */
+#include <util/delay.h>     /* for _delay_ms() */
+
+#include <avr/pgmspace.h>   /* required by usbdrv.h */
+#include "usbdrv.h"
+#include "oddebug.h"        /* This is also an example for using debug macros */
+#include "cdcacm.c"         /* virtual serial port, implements usbFunctionSetup() */
+
+#define TICKS_PER_SECOND    ((unsigned)(F_CPU / 1024))
+
+/* ------------------------------------------------------------------------- */
+
+static void pollAll(void)
+{
+    wdt_reset();
+    usbPoll();
+    cdcPoll();
+}
+
+static void putcBlocking(uchar c)
+{
+    while(!cdcPutc(c))
+        pollAll();
+}
+
+static void printString_P(PGM_P s)
+{
+char    c;
+
+    while((c = pgm_read_byte(s++)) != 0)
+        putcBlocking(c);
+}
+
+static void printResult(PGM_P name, unsigned long value)
+{
+char    digits[10];
+uchar   n = 0;
+
+    printString_P(name);
+    do{
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    }while(value != 0);
+    while(n > 0)
+        putcBlocking(digits[--n]);
+    printString_P(PSTR(" bytes/s\r\n"));
+}
+
+/* Send as much data as possible for one second. Bytes still in the transmit
+ * buffer at the end are not counted.
+ */
+static void benchmarkIn(void)
+{
+unsigned        start = TCNT1;
+unsigned long   count = 0;
+
+    while((unsigned)(TCNT1 - start) < TICKS_PER_SECOND){
+        while(cdcPutc('!' + (count & 63)))
+            count++;
+        pollAll();
+    }
+    count -= CDC_TX_BUFFER_SIZE - cdcTxFree();
+    printResult(PSTR("\r\nIN: "), count);
+}
+
+/* Count all bytes received within one second after the next byte arrives. */
+static void benchmarkOut(void)
+{
+unsigned        start;
+unsigned long   count = 0;
+uchar           buffer[8];
+
+    while(cdcRxAvailable() == 0)
+        pollAll();
+    start = TCNT1;
+    while((unsigned)(TCNT1 - start) < TICKS_PER_SECOND){
+        count += cdcRead(buffer, sizeof(buffer));
+        pollAll();
+    }
+    printResult(PSTR("OUT: "), count);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int __attribute__((noreturn)) main(void)
+{
+uchar   i;
+int     c;
+
+    wdt_enable(WDTO_1S);
+    /* If you don't use the watchdog, replace the call above with a wdt_disable().
+     * On newer devices, the status of the watchdog (on/off, period) is PRESERVED
+     * OVER RESET!
+     */
+    /* RESET status: all port bits are inputs without pull-up.
+     * That's the way we need D+ and D-. Therefore we don't need any
+     * additional hardware initialization.
+     */
+    odDebugInit();
+    DBG1(0x00, 0, 0);       /* debug output: main starts */
+    TCCR1B = (1 << CS12) | (1 << CS10); /* Timer 1 at F_CPU/1024 for benchmarks */
+    usbInit();
+    usbDeviceDisconnect();  /* enforce re-enumeration, do this while interrupts are disabled! */
+    i = 0;
+    while(--i){             /* fake USB disconnect for > 250 ms */
+        wdt_reset();
+        _delay_ms(1);
+    }
+    usbDeviceConnect();
+    sei();
+    DBG1(0x01, 0, 0);       /* debug output: main loop starts */
+    for(;;){                /* main event loop */
+        pollAll();
+        if((c = cdcGetc()) >= 0){
+            if(c == 'I'){
+                benchmarkIn();
+            }else if(c == 'O'){
+                benchmarkOut();
+            }else{
+                putcBlocking(c);
+            }
+        }
+    }
+}
+
+/* ------------------------------------------------------------------------- */
@@ -0,0 +1,42 @@
+#!/bin/sh
+# Author: V-USB contributors
+# Creation Date: 2026-10-18
+# Tabsize: 4
+# Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+# License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+
+
+if [ "$1" = remove ]; then
+    (cd firmware; make clean)
+    rm -f firmware/usbconfig.h
+    rm -rf firmware/usbdrv
+    rm -f firmware/Makefile
+    rm -f firmware/cdcacm.[ch]
+    exit
+fi
+
+cat << \EOF | sed -n -f /dev/stdin ../../usbdrv/usbconfig-prototype.h >firmware/usbconfig.h
+/^\( [*] \)\{0,1\}[+].*$/ d
+s/^#define USB_CFG_DMINUS_BIT .*$/#define USB_CFG_DMINUS_BIT      4/g
+s|^.*#define USB_CFG_CLOCK_KHZ.*$|#define USB_CFG_CLOCK_KHZ       (F_CPU/1000)|g
+s/^#define USB_CFG_HAVE_INTRIN_ENDPOINT .*$/#define USB_CFG_HAVE_INTRIN_ENDPOINT    1/g
+s/^#define USB_CFG_HAVE_INTRIN_ENDPOINT3 .*$/#define USB_CFG_HAVE_INTRIN_ENDPOINT3   1/g
+s/^#define USB_CFG_INTR_POLL_INTERVAL .*$/#define USB_CFG_INTR_POLL_INTERVAL      1/g
+s/^#define USB_CFG_IMPLEMENT_FN_WRITE .*$/#define USB_CFG_IMPLEMENT_FN_WRITE      1/g
+s/^#define USB_CFG_IMPLEMENT_FN_WRITEOUT .*$/#define USB_CFG_IMPLEMENT_FN_WRITEOUT   1/g
+s/^#define USB_CFG_HAVE_FLOWCONTROL .*$/#define USB_CFG_HAVE_FLOWCONTROL        1/g
+s|^#define  USB_CFG_DEVICE_ID .*$|#define  USB_CFG_DEVICE_ID       0xe1, 0x05 /* = 0x05e1 = 1505, shared PID for CDC-ACM */|g
+s/^#define USB_CFG_DEVICE_NAME .*$/#define USB_CFG_DEVICE_NAME     'C', 'D', 'C', '-', 'A', 'C', 'M'/g
+s/^#define USB_CFG_DEVICE_NAME_LEN .*$/#define USB_CFG_DEVICE_NAME_LEN 7/g
+s/^#define USB_CFG_DEVICE_CLASS .*$/#define USB_CFG_DEVICE_CLASS        2/g
+s/^#define USB_CFG_DESCR_PROPS_CONFIGURATION .*$/#define USB_CFG_DESCR_PROPS_CONFIGURATION           USB_PROP_LENGTH(67)/g
+p
+EOF
+
+cat << \EOF | sed -n -f /dev/stdin ../custom-class/firmware/Makefile >firmware/Makefile
+/^\( [*] \)\{0,1\}[+].*$/ d
+s/^# Project: .*$/# Project: cdc-acm example/g
+p
+EOF
+
+cp ../../libs-device/cdcacm.[ch] firmware/
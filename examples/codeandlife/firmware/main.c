@@ -100,38 +100,50 @@ static uchar ledBuf[1];
 static usbMsgLen_t dataLength = 0;
 static usbMsgLen_t dataTransferred = 0;
 
-USB_PUBLIC usbMsgLen_t usbFunctionSetup( uchar data[8] )
+static usbMsgLen_t setLed( usbRequest_t* rq )
 {
-    usbRequest_t* rq = (usbRequest_t*) data;// cast data to correct type
-    switch (rq->bRequest) {// custom command is in the bRequest field
-        case USB_SET_LED:
-            PORTC = (PORTC & ~LED_MASK) | (rq->wValue.bytes[0] & LED_MASK);
-            return 0;
-        case USB_GET_LED:
-            ledBuf[0] = PORTC & LED_MASK;
-            usbMsgPtr = ledBuf; // tell the driver which data to return
-            return 1;           // tell the driver to send 1 byte
-        case USB_STATUS_READ:// send data to PC
-            usbMsgPtr = statusBuf;
-            return sizeof( statusBuf );
-        case USB_STATUS_WRITE:// modify reply buffer
-            statusBuf[0] = rq->wValue.bytes[0];
-            statusBuf[1] = rq->wValue.bytes[1];
-            statusBuf[2] = rq->wIndex.bytes[0];
-            statusBuf[3] = rq->wIndex.bytes[1];
-            return 0;
-        case USB_DATA_WRITE:// receive data from PC
-        case USB_DATA_READ:// send data to PC
-            dataTransferred = 0;
-            dataLength = rq->wLength.word;
-            if (dataLength > sizeof( dataBuf )) {// limit to buffer size
-                dataLength = sizeof( dataBuf );
-            }
-            return USB_NO_MSG;//usbFunctionWrite/Read will be called now
+    PORTC = (PORTC & ~LED_MASK) | (rq->wValue.bytes[0] & LED_MASK);
+    return 0;
+}
+
+static usbMsgLen_t getLed( usbRequest_t* rq )
+{
+    ledBuf[0] = PORTC & LED_MASK;
+    usbMsgPtr = ledBuf; // tell the driver which data to return
+    return 1;           // tell the driver to send 1 byte
+}
+
+static usbMsgLen_t statusWrite( usbRequest_t* rq )// modify reply buffer
+{
+    statusBuf[0] = rq->wValue.bytes[0];
+    statusBuf[1] = rq->wValue.bytes[1];
+    statusBuf[2] = rq->wIndex.bytes[0];
+    statusBuf[3] = rq->wIndex.bytes[1];
+    return 0;
+}
+
+static usbMsgLen_t dataTransfer( usbRequest_t* rq )// receive data from or send data to PC
+{
+    dataTransferred = 0;
+    dataLength = rq->wLength.word;
+    if (dataLength > sizeof( dataBuf )) {// limit to buffer size
+        dataLength = sizeof( dataBuf );
     }
-    return 0;// should not get here
+    return USB_NO_MSG;//usbFunctionWrite/Read will be called now
 }
 
+// sorted by type and request number, dataTransfer() returns USB_NO_MSG for
+// usbFunctionWrite() and usbFunctionRead()
+PROGMEM const usbRequestEntry_t usbRequestTable[] = {
+    USB_REQUEST_HANDLER( USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, USB_SET_LED, setLed ),
+    USB_REQUEST_HANDLER( USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, USB_GET_LED, getLed ),
+    USB_REQUEST_RAM( USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, USB_STATUS_READ, statusBuf, sizeof( statusBuf ) ),// send data to PC
+    USB_REQUEST_HANDLER( USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, USB_STATUS_WRITE, statusWrite ),
+    USB_REQUEST_HANDLER( USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, USB_DATA_WRITE, dataTransfer ),
+    USB_REQUEST_HANDLER( USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, USB_DATA_READ, dataTransfer ),
+};
+PROGMEM const uchar usbRequestTableSize = sizeof( usbRequestTable ) / sizeof( usbRequestTable[0] );
+
 USB_PUBLIC uchar usbFunctionWrite( uchar* data, uchar len )
 {
     uchar i;
@@ -33,32 +33,49 @@ different port or bit, change the macros below:
 /* ----------------------------- USB interface ----------------------------- */
 /* ------------------------------------------------------------------------- */
 
-usbMsgLen_t usbFunctionSetup(uchar data[8])
+/* Each request has its own handler. The driver finds the handler in
+ * usbRequestTable below, so we don't need a usbFunctionSetup() function.
+ */
+
+static uchar    dataBuffer[4];  /* buffer must stay valid when the handler returns */
+
+static usbMsgLen_t  echo(usbRequest_t *rq)  /* echo -- used for reliability tests */
 {
-usbRequest_t    *rq = (void *)data;
-static uchar    dataBuffer[4];  /* buffer must stay valid when usbFunctionSetup returns */
+    dataBuffer[0] = rq->wValue.bytes[0];
+    dataBuffer[1] = rq->wValue.bytes[1];
+    dataBuffer[2] = rq->wIndex.bytes[0];
+    dataBuffer[3] = rq->wIndex.bytes[1];
+    usbMsgPtr = dataBuffer;         /* tell the driver which data to return */
+    return 4;
+}
 
-    if(rq->bRequest == CUSTOM_RQ_ECHO){ /* echo -- used for reliability tests */
-        dataBuffer[0] = rq->wValue.bytes[0];
-        dataBuffer[1] = rq->wValue.bytes[1];
-        dataBuffer[2] = rq->wIndex.bytes[0];
-        dataBuffer[3] = rq->wIndex.bytes[1];
-        usbMsgPtr = dataBuffer;         /* tell the driver which data to return */
-        return 4;
-    }else if(rq->bRequest == CUSTOM_RQ_SET_STATUS){
-        if(rq->wValue.bytes[0] & 1){    /* set LED */
-            LED_PORT_OUTPUT |= _BV(LED_BIT);
-        }else{                          /* clear LED */
-            LED_PORT_OUTPUT &= ~_BV(LED_BIT);
-        }
-    }else if(rq->bRequest == CUSTOM_RQ_GET_STATUS){
-        dataBuffer[0] = ((LED_PORT_OUTPUT & _BV(LED_BIT)) != 0);
-        usbMsgPtr = dataBuffer;         /* tell the driver which data to return */
-        return 1;                       /* tell the driver to send 1 byte */
+static usbMsgLen_t  setStatus(usbRequest_t *rq)
+{
+    if(rq->wValue.bytes[0] & 1){    /* set LED */
+        LED_PORT_OUTPUT |= _BV(LED_BIT);
+    }else{                          /* clear LED */
+        LED_PORT_OUTPUT &= ~_BV(LED_BIT);
     }
-    return 0;   /* default for not implemented requests: return no data back to host */
+    return 0;                       /* no data back to host */
 }
 
+static usbMsgLen_t  getStatus(usbRequest_t *rq)
+{
+    dataBuffer[0] = ((LED_PORT_OUTPUT & _BV(LED_BIT)) != 0);
+    usbMsgPtr = dataBuffer;         /* tell the driver which data to return */
+    return 1;                       /* tell the driver to send 1 byte */
+}
+
+/* The table must be sorted by type and request number. Requests which are
+ * not in the table return no data back to host.
+ */
+PROGMEM const usbRequestEntry_t usbRequestTable[] = {
+    USB_REQUEST_HANDLER(USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, CUSTOM_RQ_ECHO, echo),
+    USB_REQUEST_HANDLER(USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, CUSTOM_RQ_SET_STATUS, setStatus),
+    USB_REQUEST_HANDLER(USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, CUSTOM_RQ_GET_STATUS, getStatus),
+};
+PROGMEM const uchar usbRequestTableSize = sizeof(usbRequestTable) / sizeof(usbRequestTable[0]);
+
 /* ------------------------------------------------------------------------- */
 
 int __attribute__((noreturn)) main(void)
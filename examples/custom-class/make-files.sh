@@ -24,6 +24,7 @@ s/^#define USB_CFG_DEVICE_NAME .*$/#define USB_CFG_DEVICE_NAME     'L', 'E', 'D'
 s/^#define USB_CFG_DEVICE_NAME_LEN .*$/#define USB_CFG_DEVICE_NAME_LEN 10/g
 
 s/^#define USB_CFG_MAX_BUS_POWER .*$/#define USB_CFG_MAX_BUS_POWER           40/g
+s/^#define USB_CFG_HAVE_REQUEST_TABLE .*$/#define USB_CFG_HAVE_REQUEST_TABLE      1/g
 p
 EOF
 
@@ -37,41 +37,35 @@ uchar   lastTimer0Value;
 /* ----------------------------- USB interface ----------------------------- */
 /* ------------------------------------------------------------------------- */
 
+/* The driver finds the requests in usbRequestTable below, so we don't need a
+ * usbFunctionSetup() or usbFunctionWrite() function.
+ */
+
 static uchar    dataBuffer[64];
-static uchar    writeIndex;
 
-uchar usbFunctionWrite(uchar *data, uchar len)
+static usbMsgLen_t  setOsccal(usbRequest_t *rq)
 {
-
-    if(writeIndex + len <= sizeof(dataBuffer)){
-        uchar i;
-        for(i = 0; i < len; i++){
-            dataBuffer[writeIndex++] = *data++;
-        }
-    }
-    return writeIndex >= sizeof(dataBuffer);
+    OSCCAL = rq->wValue.bytes[0];
+    return 0;
 }
 
-usbMsgLen_t usbFunctionSetup(uchar data[8])
+static usbMsgLen_t  getOsccal(usbRequest_t *rq)
 {
-usbRequest_t    *rq = (void *)data;
-
-    DBG1(0x50, &rq->bRequest, 1);   /* debug output: print our request */
-    if(rq->bRequest == CUSTOM_RQ_SET_DATA){
-        writeIndex = 0;
-        return USB_NO_MSG;
-    }else if(rq->bRequest == CUSTOM_RQ_GET_DATA){
-        usbMsgPtr = dataBuffer;     /* tell the driver which data to return */
-        return sizeof(dataBuffer);  /* tell the driver how many bytes to send */
-    }else if(rq->bRequest == CUSTOM_RQ_SET_OSCCAL){
-        OSCCAL = rq->wValue.bytes[0];
-    }else if(rq->bRequest == CUSTOM_RQ_GET_OSCCAL){
-        usbMsgPtr = (uchar *)&OSCCAL;
-        return 1;
-    }
-    return 0;   /* default for not implemented requests: return no data back to host */
+    usbMsgPtr = (uchar *)&OSCCAL;
+    return 1;
 }
 
+/* Sorted by type and request number. CUSTOM_RQ_SET_DATA and
+ * CUSTOM_RQ_GET_DATA write and read the same buffer.
+ */
+PROGMEM const usbRequestEntry_t usbRequestTable[] = {
+    USB_REQUEST_RAM(USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, CUSTOM_RQ_SET_DATA, dataBuffer, sizeof(dataBuffer)),
+    USB_REQUEST_RAM(USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, CUSTOM_RQ_GET_DATA, dataBuffer, sizeof(dataBuffer)),
+    USB_REQUEST_HANDLER(USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, CUSTOM_RQ_SET_OSCCAL, setOsccal),
+    USB_REQUEST_HANDLER(USBRQ_TYPE_VENDOR | USBRQ_RCPT_DEVICE, CUSTOM_RQ_GET_OSCCAL, getOsccal),
+};
+PROGMEM const uchar usbRequestTableSize = sizeof(usbRequestTable) / sizeof(usbRequestTable[0]);
+
 /* ------------------------------------------------------------------------- */
 
 int __attribute__((noreturn)) main(void)
@@ -103,7 +103,7 @@ section at the end of this file).
  * The value is in milliamperes. [It will be divided by two since USB
  * communicates power requirements in units of 2 mA.]
  */
-#define USB_CFG_IMPLEMENT_FN_WRITE      1
+#define USB_CFG_IMPLEMENT_FN_WRITE      0
 /* Set this to 1 if you want usbFunctionWrite() to be called for control-out
  * transfers. Set it to 0 if you don't need it and want to save a couple of
  * bytes.
@@ -130,6 +130,16 @@ section at the end of this file).
  * in a single control-in or control-out transfer. Note that the capability
  * for long transfers increases the driver size.
  */
+#define USB_CFG_HAVE_REQUEST_TABLE      1
+/* Set this to 1 if class and vendor requests should be dispatched through a
+ * table in flash memory instead of usbFunctionSetup(). The table maps
+ * bmRequestType and bRequest to a handler function, a buffer in RAM or flash
+ * memory or a stream function for the data phase and is searched with a
+ * binary search. See usbRequestEntry_t in usbdrv.h for how to define the
+ * table. If set to 2, requests not found in the table are passed to
+ * usbFunctionSetup() as usual, which allows to move the most frequent
+ * requests to the table without rewriting the rest.
+ */
 /* #define USB_RX_USER_HOOK(data, len)     if(usbRxToken == (uchar)USBPID_SETUP) blinkLED(); */
 /* This macro is a hook if you want to do unconventional things. If it is
  * defined, it's inserted at the beginning of received message processing.
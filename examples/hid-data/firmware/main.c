@@ -51,19 +51,6 @@ static uchar    bytesRemaining;
 
 /* ------------------------------------------------------------------------- */
 
-/* usbFunctionRead() is called when the host requests a chunk of data from
- * the device. For more information see the documentation in usbdrv/usbdrv.h.
- */
-uchar   usbFunctionRead(uchar *data, uchar len)
-{
-    if(len > bytesRemaining)
-        len = bytesRemaining;
-    eeprom_read_block(data, (uchar *)0 + currentAddress, len);
-    currentAddress += len;
-    bytesRemaining -= len;
-    return len;
-}
-
 /* usbFunctionWrite() is called when the host sends a chunk of data to the
  * device. For more information see the documentation in usbdrv/usbdrv.h.
  */
@@ -88,9 +75,9 @@ usbRequest_t    *rq = (void *)data;
     if((rq->bmRequestType & USBRQ_TYPE_MASK) == USBRQ_TYPE_CLASS){    /* HID class request */
         if(rq->bRequest == USBRQ_HID_GET_REPORT){  /* wValue: ReportType (highbyte), ReportID (lowbyte) */
             /* since we have only one report type, we can ignore the report-ID */
-            bytesRemaining = 128;
-            currentAddress = 0;
-            return USB_NO_MSG;  /* use usbFunctionRead() to obtain data */
+            usbMsgPtr = (usbMsgPtr_t)0;     /* EEPROM address of report data */
+            usbMsgFlags = USB_FLG_MSGPTR_IS_EEPROM; /* driver reads EEPROM */
+            return 128;
         }else if(rq->bRequest == USBRQ_HID_SET_REPORT){
             /* since we have only one report type, we can ignore the report-ID */
             bytesRemaining = 128;
@@ -14,6 +14,7 @@
 #include <util/delay.h>
 
 #include "usbdrv.h"
+#include "keyqueue.c"  // packs queued keystrokes into keyboard reports
 
 // ************************
 // *** USB HID ROUTINES ***
@@ -66,6 +67,16 @@ static keyboard_report_t keyboard_report; // sent to PC
 volatile static uchar LED_state = 0xff; // received from PC
 static uchar idleRate; // repeat rate for keyboards
 
+// Vendor request: the data stage contains ASCII text to be typed, e.g.
+// usbtool -v 0x16c0 -p 0x05dc -D text.txt control out vendor device 1 0 0
+#define RQ_TYPE_TEXT 1
+
+static uchar writingText; // usbFunctionWrite() receives text, not LED state
+static usbMsgLen_t textRemaining;
+
+// Flash-resident macro typed when the button is pressed
+static PROGMEM const char buttonMacro[] = "Hello from V-USB!\n";
+
 usbMsgLen_t usbFunctionSetup(uchar data[8]) {
     usbRequest_t *rq = (void *)data;
 
@@ -78,6 +89,7 @@ usbMsgLen_t usbFunctionSetup(uchar data[8]) {
             keyboard_report.keycode[0] = 0;
             return sizeof(keyboard_report);
 		case USBRQ_HID_SET_REPORT: // if wLength == 1, should be LED state
+            writingText = 0;
             return (rq->wLength.word == 1) ? USB_NO_MSG : 0;
         case USBRQ_HID_GET_IDLE: // send idle rate to PC as required by spec
             usbMsgPtr = &idleRate;
@@ -86,6 +98,12 @@ usbMsgLen_t usbFunctionSetup(uchar data[8]) {
             idleRate = rq->wValue.bytes[1];
             return 0;
         }
+    } else if((rq->bmRequestType & USBRQ_TYPE_MASK) == USBRQ_TYPE_VENDOR) {
+        if(rq->bRequest == RQ_TYPE_TEXT && rq->wLength.word > 0) {
+            writingText = 1;
+            textRemaining = rq->wLength.word;
+            return USB_NO_MSG; // receive text in usbFunctionWrite()
+        }
     }
     
     return 0; // by default don't return any data
@@ -96,6 +114,24 @@ usbMsgLen_t usbFunctionSetup(uchar data[8]) {
 #define SCROLL_LOCK 4
 
 usbMsgLen_t usbFunctionWrite(uint8_t * data, uchar len) {
+    if(writingText) {
+        uchar i;
+        if(len > textRemaining)
+            len = textRemaining;
+        for(i = 0; i < len; i++){
+            if(!keyQueuePutChar(data[i])){  // queue full: report error
+                writingText = 0;
+                return 0xff;
+            }
+        }
+        textRemaining -= len;
+        // NAK further data until the queue can take a full packet again,
+        // see main loop. A playing macro leaves KEYQUEUE_MACRO_RESERVE (8)
+        // entries free for this.
+        if(keyQueueFree() < 8)
+            usbDisableAllRequests();
+        return textRemaining == 0;
+    }
 	//if (data[0] == LED_state) {
     //    return 1;
     //} else {
@@ -111,23 +147,8 @@ usbMsgLen_t usbFunctionWrite(uint8_t * data, uchar len) {
 	return 1; // Data read, not expecting more
 }
 
-// Now only supports letters 'a' to 'z' and 0 (NULL) to clear buttons
-void buildReport(uchar send_key) {
-	keyboard_report.modifier = 0;
-	
-	if(send_key >= 'a' && send_key <= 'z')
-		keyboard_report.keycode[0] = 4+(send_key-'a');
-	else
-		keyboard_report.keycode[0] = 0;
-}
-
-#define STATE_WAIT 0
-#define STATE_SEND_KEY 1
-#define STATE_RELEASE_KEY 2
-
 int main() {
-	uchar i, button_release_counter = 0, state = STATE_WAIT;
-
+	uchar i, button_release_counter = 0;
 	//DDRB = 1 << PB0; // PB0 as output
     DDRC = 0x3f;
 	PORTB = 1 << PB1; // PB1 is input with internal pullup resistor activated
@@ -164,14 +185,17 @@ int main() {
         
 		if(!(PINB & (1<<PB1))) { // button pressed (PB1 at ground voltage)
 			// also check if some time has elapsed since last button press
-			if(state == STATE_WAIT && button_release_counter == 8)
-				state = STATE_SEND_KEY;
+			if(button_release_counter == 8)
+				keyQueuePlay_P(buttonMacro);
 				
 			button_release_counter = 0; // now button needs to be released a while until retrigger
 		}
     	if(button_release_counter < 8) 
 			button_release_counter++; // increase release counter
 
+        if(usbAllRequestsAreDisabled() && keyQueueFree() >= 8)
+            usbEnableAllRequests(); // room for the next packet of text
+
         cnt++;
         if (cnt == 0) {
             if (led == 0) {
@@ -184,25 +208,10 @@ int main() {
         }
 
         if(usbInterruptIsReady()) {
-            // characters are sent when messageState == STATE_SEND and after receiving
-            // the initial LED state from PC (good way to wait until device is recognized)
-            if (state != STATE_WAIT && LED_state != 0xff){
-                switch(state) {
-                case STATE_SEND_KEY:
-                    buildReport('x');
-                    state = STATE_RELEASE_KEY; // release next
-                    break;
-                case STATE_RELEASE_KEY:
-                    buildReport(0);
-                    state = STATE_WAIT; // go back to waiting
-                    break;
-                default:
-                    state = STATE_WAIT; // should not happen
-                }
-                
-                // start sending
+            // keys are sent after receiving the initial LED state from PC
+            // (good way to wait until device is recognized)
+            if(LED_state != 0xff && keyQueueBuildReport((uchar *)&keyboard_report))
                 usbSetInterrupt((void *)&keyboard_report, sizeof(keyboard_report));
-            }
         }
     }
 	
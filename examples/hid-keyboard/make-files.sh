@@ -11,6 +11,7 @@ if [ "$1" = remove ]; then
     rm -f firmware/usbconfig.h
     rm -rf firmware/usbdrv
     rm -f firmware/Makefile
+    rm -f firmware/keyqueue.[ch]
     exit
 fi
 
@@ -24,10 +25,12 @@ s/^#define USB_CFG_DEVICE_NAME .*$/#define USB_CFG_DEVICE_NAME     'K', 'e', 'y'
 s/^#define USB_CFG_DEVICE_NAME_LEN .*$/#define USB_CFG_DEVICE_NAME_LEN 8/g
 
 s/^#define USB_CFG_INTR_POLL_INTERVAL .*$/#define USB_CFG_INTR_POLL_INTERVAL      30/g
+s/^#define USB_CFG_IMPLEMENT_FN_WRITE .*$/#define USB_CFG_IMPLEMENT_FN_WRITE      1/g
+s/^#define USB_CFG_HAVE_FLOWCONTROL .*$/#define USB_CFG_HAVE_FLOWCONTROL        1/g
 s/^#define USB_CFG_MAX_BUS_POWER .*$/#define USB_CFG_MAX_BUS_POWER           50/g
 s/^#define USB_CFG_DEVICE_CLASS .*$/#define USB_CFG_DEVICE_CLASS        0/g
 s/^#define USB_CFG_INTERFACE_CLASS .*$/#define USB_CFG_INTERFACE_CLASS     3/g
-s/^.*#define USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH.*$/#define USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH    52/g
+s/^.*#define USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH.*$/#define USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH    63/g
 p
 EOF
 
@@ -36,3 +39,5 @@ cat << \EOF | sed -n -f /dev/stdin ../custom-class/firmware/Makefile >firmware/M
 s/^# Project: .*$/# Project: hid-keyboard example/g
 p
 EOF
+
+cp ../../libs-device/keyqueue.[ch] firmware/
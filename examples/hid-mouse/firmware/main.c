@@ -25,6 +25,7 @@ publish any hardware using these IDs! This is for demonstration only!
 #include <avr/pgmspace.h>   /* required by usbdrv.h */
 #include "usbdrv.h"
 #include "oddebug.h"        /* This is also an example for using debug macros */
+#include "hidpointer.c"     /* accumulates motion between interrupt polls */
 
 /* ------------------------------------------------------------------------- */
 /* ----------------------------- USB interface ----------------------------- */
@@ -82,8 +83,8 @@ static uchar    idleRate;   /* repeat rate for keyboards, never used for mice */
 // N = 2pi / dTheta = 2pi * 64
 
 /* The following function advances sin/cos by a fixed angle
- * and stores the difference to the previous coordinates in the report
- * descriptor.
+ * and feeds the difference to the previous coordinates into the pointer
+ * accumulator (see hidpointer.h).
  * The algorithm is the simulation of a second order differential equation.
  */
 static void advanceCircleByFixedAngle(void)
@@ -91,12 +92,13 @@ static void advanceCircleByFixedAngle(void)
 #define SHIFT 7
 #define DIVIDE_BY_SHIFT(val)  (val + (val > 0 ? (1 << (SHIFT-1)) : -(1 << (SHIFT - 1)))) >> SHIFT    /* rounding divide */
 static int      sinus = 1000, cosinus = 0;
-char    d;
+char    dx, dy;
 
-    reportBuffer.dx = d = DIVIDE_BY_SHIFT(cosinus);
-    sinus += d;
-    reportBuffer.dy = d = DIVIDE_BY_SHIFT(sinus);
-    cosinus -= d;
+    dx = DIVIDE_BY_SHIFT(cosinus);
+    sinus += dx;
+    dy = DIVIDE_BY_SHIFT(sinus);
+    cosinus -= dy;
+    pointerMove(dx, dy, 0);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -133,6 +135,10 @@ ISR(TIMER0_OVF_vect)
    cnt0 += 1;
 }
 static int16_t cnt0_us = (int16_t) (1.0e6f * 256 / (F_CPU) + 0.5f);
+/* The circle advances every 10 ms, independent of the poll interval. Steps
+ * which occur between two interrupt polls are summed up by the accumulator.
+ */
+#define STEP_TICKS  ((int16_t)((F_CPU) / 256 / 100))
 
 int __attribute__((noreturn)) main(void)
 {
@@ -170,14 +176,20 @@ uchar   i;
     PORTC = 0x3f;
     //char cnt = 0;
     int16_t last = cnt0;
+    int16_t lastStep = last;
     int32_t elapsed = 8000 / cnt0_us;
     for(;;){                /* main event loop */
         DBG1(0x02, 0, 0);   /* debug output: main loop iterates */
         wdt_reset();
         usbPoll();
+        if((int16_t)(cnt0 - lastStep) >= STEP_TICKS){
+            lastStep += STEP_TICKS;
+            advanceCircleByFixedAngle();
+        }
         if(usbInterruptIsReady()){
             /* called after every poll of the interrupt endpoint */
-            advanceCircleByFixedAngle();
+            if(!pointerBuildReport((uchar *)&reportBuffer))
+                continue;   /* nothing moved, no need to send a report */
             DBG1(0x03, 0, 0);   /* debug output: interrupt report prepared */
             usbSetInterrupt((void *)&reportBuffer, sizeof(reportBuffer));
 
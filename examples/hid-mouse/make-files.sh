@@ -11,6 +11,7 @@ if [ "$1" = remove ]; then
     rm -f firmware/usbconfig.h
     rm -rf firmware/usbdrv
     rm -f firmware/Makefile
+    rm -f firmware/hidpointer.[ch]
     exit
 fi
 
@@ -36,3 +37,5 @@ cat << \EOF | sed -n -f /dev/stdin ../custom-class/firmware/Makefile >firmware/M
 s/^# Project: .*$/# Project: hid-mouse example/g
 p
 EOF
+
+cp ../../libs-device/hidpointer.[ch] firmware/
@@ -0,0 +1,210 @@
+/* Name: latency.c
+ * Project: latency example
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+General Description:
+This is the host-side tool for the latency example device. It reads the
+timestamped reports from interrupt endpoint 1 and compares the device time
+of each event with the time when the report was received.
+
+The device time is derived from the USB frame clock (see
+libs-device/softime.h), the receive time from the host's system clock. The
+tool fits a straight line through the differences to remove the offset and
+drift between both clocks. The remaining deviation is the latency of the
+report, relative to the fastest report received. It contains the time the
+report waited for the next interrupt poll plus the variation of the host's
+USB stack, but not the constant part of the latency.
+
+Two histograms are printed:
+latency ... distribution of the relative latency as described above.
+jitter .... difference between the interval of two consecutive reports at
+            the host and the interval of the corresponding events at the
+            device.
+
+This program must be linked with libusb on Unix and libusb-win32 on Windows.
+See http://libusb.sourceforge.net/ or http://libusb-win32.sourceforge.net/
+respectively.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+#include <usb.h>        /* this is libusb */
+#include "opendevice.h" /* common code moved to separate module */
+
+#include "../firmware/usbconfig.h"  /* device's VID/PID and names */
+
+#define MAX_SAMPLES     100000
+#define BIN_WIDTH       250     /* histogram bin width in microseconds */
+#define NUM_BINS        48
+#define BAR_WIDTH       50
+
+static double   deviceTime[MAX_SAMPLES];    /* in microseconds */
+static double   hostTime[MAX_SAMPLES];      /* in microseconds */
+
+static void usage(char *name)
+{
+    fprintf(stderr, "usage:\n");
+    fprintf(stderr, "  %s [<number of reports>] ... default is 2000 reports\n", name);
+}
+
+static double   now(void)
+{
+struct timeval  tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+/* Print a histogram of 'n' values in microseconds, starting at 'origin'. */
+static void printHistogram(const char *title, double *values, int n, double origin)
+{
+int     bins[NUM_BINS], i, maxCount = 0, lastBin = 0;
+double  sum = 0, sumSquares = 0, min = values[0], max = values[0];
+
+    memset(bins, 0, sizeof(bins));
+    for(i = 0; i < n; i++){
+        int bin = (int)((values[i] - origin) / BIN_WIDTH);
+        if(bin < 0)
+            bin = 0;
+        if(bin >= NUM_BINS)
+            bin = NUM_BINS - 1;
+        bins[bin]++;
+        sum += values[i];
+        sumSquares += values[i] * values[i];
+        if(values[i] < min)
+            min = values[i];
+        if(values[i] > max)
+            max = values[i];
+    }
+    for(i = 0; i < NUM_BINS; i++){
+        if(bins[i] > maxCount)
+            maxCount = bins[i];
+        if(bins[i] != 0)
+            lastBin = i;
+    }
+    sum /= n;
+    printf("\n%s: mean = %.3f ms, std dev = %.3f ms, min = %.3f ms, max = %.3f ms\n", title,
+        sum / 1000, sqrt(sumSquares / n - sum * sum) / 1000, min / 1000, max / 1000);
+    for(i = 0; i <= lastBin; i++){
+        int len = bins[i] * BAR_WIDTH / maxCount;
+        printf("%7.2f ms%s %6d |", (origin + i * BIN_WIDTH) / 1000, i == NUM_BINS - 1 ? "+" : " ", bins[i]);
+        while(len-- > 0)
+            putchar('#');
+        putchar('\n');
+    }
+}
+
+int main(int argc, char **argv)
+{
+usb_dev_handle      *handle = NULL;
+const unsigned char rawVid[2] = {USB_CFG_VENDOR_ID}, rawPid[2] = {USB_CFG_DEVICE_ID};
+char                vendor[] = {USB_CFG_VENDOR_NAME, 0}, product[] = {USB_CFG_DEVICE_NAME, 0};
+unsigned char       buffer[8];
+int                 cnt, vid, pid, i, n = 0, numReports = 2000, lost = 0, ticksPerMs = 0, pollInterval = 0;
+unsigned char       lastSequence = 0, lastSof = 0, lastDropped = 0;
+double              frames = 0, sx = 0, sy = 0, sxx = 0, sxy = 0, slope, offset, minLatency;
+double              *latency, *jitter;
+
+    usb_init();
+    if(argc > 2 || (argc == 2 && (numReports = atoi(argv[1])) <= 1)){
+        usage(argv[0]);
+        exit(1);
+    }
+    if(numReports > MAX_SAMPLES)
+        numReports = MAX_SAMPLES;
+    /* compute VID/PID from usbconfig.h so that there is a central source of information */
+    vid = rawVid[1] * 256 + rawVid[0];
+    pid = rawPid[1] * 256 + rawPid[0];
+    /* The following function is in opendevice.c: */
+    if(usbOpenDevice(&handle, vid, vendor, pid, product, NULL, NULL, NULL) != 0){
+        fprintf(stderr, "Could not find USB device \"%s\" with vid=0x%x pid=0x%x\n", product, vid, pid);
+        exit(1);
+    }
+    /* We read an interrupt endpoint, so we must select the configuration and
+     * claim the interface.
+     */
+    if(usb_set_configuration(handle, 1) != 0){
+        fprintf(stderr, "Warning: could not set configuration: %s\n", usb_strerror());
+    }
+    if(usb_claim_interface(handle, 0) != 0){
+        fprintf(stderr, "Could not claim interface: %s\n", usb_strerror());
+        exit(1);
+    }
+    while(n < numReports){
+        cnt = usb_interrupt_read(handle, USB_ENDPOINT_IN | 1, (char *)buffer, sizeof(buffer), 5000);
+        hostTime[n] = now();
+        if(cnt != sizeof(buffer)){
+            fprintf(stderr, "USB error: %s\n", cnt < 0 ? usb_strerror() : "short report");
+            exit(1);
+        }
+        if(n == 0){
+            ticksPerMs = buffer[4] | (buffer[5] << 8);
+            pollInterval = buffer[6];
+            if(ticksPerMs == 0){
+                fprintf(stderr, "Invalid report from device\n");
+                exit(1);
+            }
+        }else{
+            lost += (unsigned char)(buffer[0] - lastSequence - 1);
+            lost += (unsigned char)(buffer[7] - lastDropped);
+            /* Reports arrive much more often than every 256 ms, so the SOF
+             * count can be extended to an unlimited frame number.
+             */
+            frames += (unsigned char)(buffer[1] - lastSof);
+        }
+        lastSequence = buffer[0];
+        lastSof = buffer[1];
+        lastDropped = buffer[7];
+        deviceTime[n] = frames * 1000 + (buffer[2] | (buffer[3] << 8)) * 1000.0 / ticksPerMs;
+        n++;
+        if(n % 100 == 0){
+            fprintf(stderr, "\r%d reports", n);
+            fflush(stderr);
+        }
+    }
+    fprintf(stderr, "\n");
+    usb_release_interface(handle, 0);
+    usb_close(handle);
+
+    /* least squares fit of (host time - device time) over device time */
+    for(i = 0; i < n; i++){
+        double x = deviceTime[i], y = (hostTime[i] - hostTime[0]) - x;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    slope = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    offset = (sy - slope * sx) / n;
+    latency = malloc(n * sizeof(double));
+    jitter = malloc(n * sizeof(double));
+    if(latency == NULL || jitter == NULL){
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    minLatency = 1e30;
+    for(i = 0; i < n; i++){
+        latency[i] = (hostTime[i] - hostTime[0]) - deviceTime[i] - (offset + slope * deviceTime[i]);
+        if(latency[i] < minLatency)
+            minLatency = latency[i];
+    }
+    for(i = 0; i < n; i++){
+        latency[i] -= minLatency;
+        if(i > 0)
+            jitter[i - 1] = (hostTime[i] - hostTime[i - 1]) - (deviceTime[i] - deviceTime[i - 1]) * (1 + slope);
+    }
+    printf("%d reports, poll interval %d ms, %d events lost, clock drift %.1f ppm\n",
+        n, pollInterval, lost, slope * 1e6);
+    printHistogram("latency", latency, n, 0);
+    printHistogram("jitter", jitter, n - 1, -(NUM_BINS / 2) * BIN_WIDTH);
+    return 0;
+}
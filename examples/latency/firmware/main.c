@@ -0,0 +1,115 @@
+/* Name: main.c
+ * Project: latency example
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+This example generates events at a fixed rate which is not a multiple of the
+USB frame rate and reports each event on interrupt endpoint 1. Every report
+carries the time of the event as timestamp from libs-device/softime.c. The
+host tool in ../commandline compares these timestamps with the time when the
+reports arrive and computes latency and jitter histograms.
+
+Report layout (8 bytes):
+    [0] ....... sequence number, incremented for each event
+    [1..3] .... timestamp of the event, see softimeStamp()
+    [4..5] .... SOFTIME_TICKS_PER_MS, little endian
+    [6] ....... USB_CFG_INTR_POLL_INTERVAL
+    [7] ....... number of events dropped because the previous report was
+                still waiting for the host (modulo 256)
+*/
+
+#include <avr/io.h>
+#include <avr/wdt.h>
+#include <avr/interrupt.h>  /* for sei() */
+#include <util/delay.h>     /* for _delay_ms() */
+
+#include <avr/pgmspace.h>   /* required by usbdrv.h */
+#include "usbdrv.h"
+#include "oddebug.h"        /* This is also an example for using debug macros */
+#include "softime.c"        /* SOF synchronized timestamps */
+
+/* 3.7 ms between events, so that events occur at all phases of the frame */
+#define EVENT_TICKS     ((unsigned short)(SOFTIME_TICKS_PER_MS * 37 / 10))
+#if SOFTIME_TICKS_PER_MS * 37 / 10 > 0xffff  /* above 17.7 MHz with prescaling 1 */
+#error "3.7 ms don't fit into the 16 bit timer, increase SOFTIME_PRESCALING"
+#endif
+
+static uchar    report[8];
+static uchar    reportPending;
+static uchar    sequence;
+static uchar    dropped;
+
+/* ------------------------------------------------------------------------- */
+/* ----------------------------- USB interface ----------------------------- */
+/* ------------------------------------------------------------------------- */
+
+usbMsgLen_t usbFunctionSetup(uchar data[8])
+{
+    return 0;   /* no vendor requests implemented */
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void event(void)
+{
+    if(reportPending){
+        dropped++;
+        return;
+    }
+    report[0] = sequence++;
+    softimeStamp(&report[1]);
+    report[4] = SOFTIME_TICKS_PER_MS & 0xff;
+    report[5] = SOFTIME_TICKS_PER_MS >> 8;
+    report[6] = USB_CFG_INTR_POLL_INTERVAL;
+    report[7] = dropped;
+    reportPending = 1;
+}
+
+int __attribute__((noreturn)) main(void)
+{
+uchar           i;
+unsigned short  lastEvent;
+
+    wdt_enable(WDTO_1S);
+    /* If you don't use the watchdog, replace the call above with a wdt_disable().
+     * On newer devices, the status of the watchdog (on/off, period) is PRESERVED
+     * OVER RESET!
+     */
+    /* RESET status: all port bits are inputs without pull-up.
+     * That's the way we need D+ and D-. Therefore we don't need any
+     * additional hardware initialization.
+     */
+    odDebugInit();
+    DBG1(0x00, 0, 0);       /* debug output: main starts */
+    softimeInit();
+    usbInit();
+    usbDeviceDisconnect();  /* enforce re-enumeration, do this while interrupts are disabled! */
+    i = 0;
+    while(--i){             /* fake USB disconnect for > 250 ms */
+        wdt_reset();
+        _delay_ms(1);
+    }
+    usbDeviceConnect();
+    sei();
+    DBG1(0x01, 0, 0);       /* debug output: main loop starts */
+    lastEvent = softimeTimer();
+    for(;;){                /* main event loop */
+        wdt_reset();
+        usbPoll();
+        if((unsigned short)(softimeTimer() - lastEvent) >= EVENT_TICKS){
+            lastEvent += EVENT_TICKS;
+            event();
+        }
+        if(reportPending && usbInterruptIsReady()){
+            usbSetInterrupt(report, sizeof(report));
+            reportPending = 0;
+        }
+    }
+}
+
+/* ------------------------------------------------------------------------- */
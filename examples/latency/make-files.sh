@@ -0,0 +1,56 @@
+#!/bin/sh
+# Author: V-USB contributors
+# Creation Date: 2026-10-18
+# Tabsize: 4
+# Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+# License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+
+
+if [ "$1" = remove ]; then
+    (cd firmware; make clean)
+    rm -f firmware/usbconfig.h
+    rm -rf firmware/usbdrv
+    rm -f firmware/Makefile
+    rm -f firmware/softime.[ch]
+    rm -f commandline/Makefile.windows
+    rm -f commandline/Makefile
+    rm -f commandline/opendevice.[ch]
+    exit
+fi
+
+cat << \EOF | sed -n -f /dev/stdin ../../usbdrv/usbconfig-prototype.h >firmware/usbconfig.h
+/^\( [*] \)\{0,1\}[+].*$/ d
+s/^#define USB_CFG_DMINUS_BIT .*$/#define USB_CFG_DMINUS_BIT      2/g
+s/^#define USB_CFG_DPLUS_BIT .*$/#define USB_CFG_DPLUS_BIT       4/g
+s|^.*#define USB_CFG_CLOCK_KHZ.*$|#define USB_CFG_CLOCK_KHZ       (F_CPU/1000)|g
+s/^#define USB_CFG_HAVE_INTRIN_ENDPOINT .*$/#define USB_CFG_HAVE_INTRIN_ENDPOINT    1/g
+s/^#define USB_COUNT_SOF .*$/#define USB_COUNT_SOF                   1/g
+/^#define USB_COUNT_SOF /a\
+#include "softime.h"    /* defines USB_SOF_HOOK */
+s/^#define USB_CFG_DEVICE_NAME .*$/#define USB_CFG_DEVICE_NAME     'L', 'a', 't', 'e', 'n', 'c', 'y'/g
+s/^#define USB_CFG_DEVICE_NAME_LEN .*$/#define USB_CFG_DEVICE_NAME_LEN 7/g
+p
+EOF
+
+cat << \EOF | sed -n -f /dev/stdin ../custom-class/firmware/Makefile >firmware/Makefile
+/^\( [*] \)\{0,1\}[+].*$/ d
+s/^# Project: .*$/# Project: latency example/g
+p
+EOF
+
+cat << \EOF | sed -n -f /dev/stdin ../usbtool/Makefile.windows >commandline/Makefile.windows
+/^\( [*] \)\{0,1\}[+].*$/ d
+s/^# Project: .*$/# Project: latency example/g
+p
+EOF
+
+cat << \EOF | sed -n -f /dev/stdin ../usbtool/Makefile >commandline/Makefile
+/^\( [*] \)\{0,1\}[+].*$/ d
+s/^# Project: .*$/# Project: latency example/g
+s/^NAME = .*$/NAME = latency/g
+s/^USBLIBS = \(.*\)$/USBLIBS = \1 -lm/g
+p
+EOF
+
+cp ../../libs-device/softime.[ch] firmware/
+cp ../../libs-host/opendevice.[ch] commandline/
@@ -0,0 +1,116 @@
+/* Name: main.c
+ * Project: midi example
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+This example implements a USB-MIDI device with libs-device/usbmidi.c. Notes
+received from the host are echoed one octave higher. A Program Change
+message starts a controller sweep: controller 1 runs from 0 to 127 and
+controller 2 from 127 to 0, with one step per millisecond. This results in
+two messages per millisecond, which fits into one low speed packet per poll
+interval only because usbmidi.c packs two events into each packet.
+
+Time is measured in milliseconds with Timer 1 at F_CPU/64.
+*/
+
+#include <avr/io.h>
+#include <avr/wdt.h>
+#include <avr/interrupt.h>  /* for sei() */
+#include <util/delay.h>     /* for _delay_ms() */
+
+#include <avr/pgmspace.h>   /* required by usbdrv.h */
+#include "usbdrv.h"
+#include "oddebug.h"        /* This is also an example for using debug macros */
+#include "usbmidi.c"        /* USB-MIDI class, implements usbFunctionWriteOut() */
+
+#define TICKS_PER_MS    ((unsigned)(F_CPU / 64000))
+#define SWEEP_AHEAD     4   /* schedule sweep events up to 4 ms in advance */
+
+static uchar    sweepValue = 128;   /* 128 = no sweep running */
+static uchar    sweepTime;
+
+/* ------------------------------------------------------------------------- */
+/* ----------------------------- USB interface ----------------------------- */
+/* ------------------------------------------------------------------------- */
+
+usbMsgLen_t usbFunctionSetup(uchar data[8])
+{
+    return 0;   /* no class or vendor requests implemented */
+}
+
+void    midiEventReceived(uchar *event)
+{
+uchar   status = event[1] & 0xf0;
+
+    if((status == 0x80 || status == 0x90) && event[2] < 128 - 12){
+        midiSend(event[1], event[2] + 12, event[3]);
+    }else if(status == 0xc0){
+        sweepValue = 0;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Queue the next sweep steps. Scheduling them a few milliseconds ahead makes
+ * the timing independent of main loop latency.
+ */
+static void sweepPoll(uchar now)
+{
+    if(sweepValue == 128)
+        sweepTime = now;
+    while(sweepValue < 128 && (signed char)(sweepTime - now) < SWEEP_AHEAD && midiQueueFree() >= 2){
+        midiSendAt(sweepTime, 0xb0, 1, sweepValue);
+        midiSendAt(sweepTime, 0xb0, 2, 127 - sweepValue);
+        sweepValue++;
+        sweepTime++;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+int __attribute__((noreturn)) main(void)
+{
+uchar       i, ms = 0;
+unsigned    lastTick;
+
+    wdt_enable(WDTO_1S);
+    /* If you don't use the watchdog, replace the call above with a wdt_disable().
+     * On newer devices, the status of the watchdog (on/off, period) is PRESERVED
+     * OVER RESET!
+     */
+    /* RESET status: all port bits are inputs without pull-up.
+     * That's the way we need D+ and D-. Therefore we don't need any
+     * additional hardware initialization.
+     */
+    odDebugInit();
+    DBG1(0x00, 0, 0);       /* debug output: main starts */
+    TCCR1B = (1 << CS11) | (1 << CS10); /* Timer 1 at F_CPU/64 for timestamps */
+    usbInit();
+    usbDeviceDisconnect();  /* enforce re-enumeration, do this while interrupts are disabled! */
+    i = 0;
+    while(--i){             /* fake USB disconnect for > 250 ms */
+        wdt_reset();
+        _delay_ms(1);
+    }
+    usbDeviceConnect();
+    sei();
+    DBG1(0x01, 0, 0);       /* debug output: main loop starts */
+    lastTick = TCNT1;
+    for(;;){                /* main event loop */
+        wdt_reset();
+        while((unsigned)(TCNT1 - lastTick) >= TICKS_PER_MS){
+            lastTick += TICKS_PER_MS;
+            ms++;
+        }
+        usbPoll();
+        sweepPoll(ms);
+        midiPoll(ms);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
@@ -0,0 +1,38 @@
+#!/bin/sh
+# Author: V-USB contributors
+# Creation Date: 2026-10-18
+# Tabsize: 4
+# Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+# License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+
+
+if [ "$1" = remove ]; then
+    (cd firmware; make clean)
+    rm -f firmware/usbconfig.h
+    rm -rf firmware/usbdrv
+    rm -f firmware/Makefile
+    rm -f firmware/usbmidi.[ch]
+    exit
+fi
+
+cat << \EOF | sed -n -f /dev/stdin ../../usbdrv/usbconfig-prototype.h >firmware/usbconfig.h
+/^\( [*] \)\{0,1\}[+].*$/ d
+s/^#define USB_CFG_DMINUS_BIT .*$/#define USB_CFG_DMINUS_BIT      4/g
+s|^.*#define USB_CFG_CLOCK_KHZ.*$|#define USB_CFG_CLOCK_KHZ       (F_CPU/1000)|g
+s/^#define USB_CFG_HAVE_INTRIN_ENDPOINT .*$/#define USB_CFG_HAVE_INTRIN_ENDPOINT    1/g
+s/^#define USB_CFG_INTR_POLL_INTERVAL .*$/#define USB_CFG_INTR_POLL_INTERVAL      1/g
+s/^#define USB_CFG_IMPLEMENT_FN_WRITEOUT .*$/#define USB_CFG_IMPLEMENT_FN_WRITEOUT   1/g
+s|^#define  USB_CFG_DEVICE_ID .*$|#define  USB_CFG_DEVICE_ID       0xe4, 0x05 /* = 0x05e4 = 1508, shared PID for MIDI */|g
+s/^#define USB_CFG_DEVICE_NAME .*$/#define USB_CFG_DEVICE_NAME     'M', 'I', 'D', 'I'/g
+s/^#define USB_CFG_DEVICE_NAME_LEN .*$/#define USB_CFG_DEVICE_NAME_LEN 4/g
+s/^#define USB_CFG_DESCR_PROPS_CONFIGURATION .*$/#define USB_CFG_DESCR_PROPS_CONFIGURATION           USB_PROP_LENGTH(101)/g
+p
+EOF
+
+cat << \EOF | sed -n -f /dev/stdin ../custom-class/firmware/Makefile >firmware/Makefile
+/^\( [*] \)\{0,1\}[+].*$/ d
+s/^# Project: .*$/# Project: midi example/g
+p
+EOF
+
+cp ../../libs-device/usbmidi.[ch] firmware/
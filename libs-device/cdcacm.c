@@ -0,0 +1,245 @@
+/* Name: cdcacm.c
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+#include <avr/pgmspace.h>
+#include "usbdrv.h"
+#include "cdcacm.h"
+
+#if !USB_CFG_HAVE_INTRIN_ENDPOINT || !USB_CFG_HAVE_INTRIN_ENDPOINT3
+#error "cdcacm.c requires USB_CFG_HAVE_INTRIN_ENDPOINT and USB_CFG_HAVE_INTRIN_ENDPOINT3"
+#endif
+#if !USB_CFG_IMPLEMENT_FN_WRITE || !USB_CFG_IMPLEMENT_FN_WRITEOUT
+#error "cdcacm.c requires USB_CFG_IMPLEMENT_FN_WRITE and USB_CFG_IMPLEMENT_FN_WRITEOUT"
+#endif
+#if !USB_CFG_HAVE_FLOWCONTROL
+#error "cdcacm.c requires USB_CFG_HAVE_FLOWCONTROL"
+#endif
+#if USB_PROP_LENGTH_OF(USB_CFG_DESCR_PROPS_CONFIGURATION) != CDC_CONFIG_DESCRIPTOR_LENGTH
+#error "USB_CFG_DESCR_PROPS_CONFIGURATION must be USB_PROP_LENGTH(CDC_CONFIG_DESCRIPTOR_LENGTH)"
+#endif
+
+/* ------------------------------------------------------------------------- */
+/* ----------------------------- Descriptors ------------------------------- */
+/* ------------------------------------------------------------------------- */
+
+PROGMEM const char usbDescriptorConfiguration[CDC_CONFIG_DESCRIPTOR_LENGTH] = {
+    9,          /* sizeof(usbDescriptorConfiguration): length of descriptor in bytes */
+    USBDESCR_CONFIG,    /* descriptor type */
+    CDC_CONFIG_DESCRIPTOR_LENGTH, 0,    /* total length of data returned (including inlined descriptors) */
+    2,          /* number of interfaces in this configuration */
+    1,          /* index of this configuration */
+    0,          /* configuration name string index */
+#if USB_CFG_IS_SELF_POWERED
+    (1 << 7) | USBATTR_SELFPOWER,       /* attributes */
+#else
+    (1 << 7),                           /* attributes */
+#endif
+    USB_CFG_MAX_BUS_POWER/2,            /* max USB current in 2mA units */
+/* communication interface: */
+    9,          /* sizeof(usbDescrInterface): length of descriptor in bytes */
+    USBDESCR_INTERFACE, /* descriptor type */
+    0,          /* index of this interface */
+    0,          /* alternate setting for this interface */
+    1,          /* endpoints excl 0: number of endpoint descriptors to follow */
+    2,          /* interface class: communication */
+    2,          /* interface subclass: abstract control model */
+    1,          /* interface protocol: AT commands (V.250) */
+    0,          /* string index for interface */
+/* header functional descriptor: */
+    5,          /* sizeof(header functional descriptor) */
+    0x24,       /* descriptor type: CS_INTERFACE */
+    0,          /* descriptor subtype: header */
+    0x10, 0x01, /* CDC specification release 1.10 */
+/* call management functional descriptor: */
+    5,          /* sizeof(call management functional descriptor) */
+    0x24,       /* descriptor type: CS_INTERFACE */
+    1,          /* descriptor subtype: call management */
+    0,          /* capabilities: no call management */
+    1,          /* data interface */
+/* abstract control management functional descriptor: */
+    4,          /* sizeof(ACM functional descriptor) */
+    0x24,       /* descriptor type: CS_INTERFACE */
+    2,          /* descriptor subtype: abstract control management */
+    0x02,       /* capabilities: line coding and control line state */
+/* union functional descriptor: */
+    5,          /* sizeof(union functional descriptor) */
+    0x24,       /* descriptor type: CS_INTERFACE */
+    6,          /* descriptor subtype: union */
+    0,          /* master interface: communication */
+    1,          /* slave interface: data */
+/* notification endpoint: */
+    7,          /* sizeof(usbDescrEndpoint) */
+    USBDESCR_ENDPOINT,  /* descriptor type = endpoint */
+    (char)0x81, /* IN endpoint number 1 */
+    0x03,       /* attrib: Interrupt endpoint */
+    8, 0,       /* maximum packet size */
+    USB_CFG_INTR_POLL_INTERVAL, /* in ms */
+/* data interface: */
+    9,          /* sizeof(usbDescrInterface): length of descriptor in bytes */
+    USBDESCR_INTERFACE, /* descriptor type */
+    1,          /* index of this interface */
+    0,          /* alternate setting for this interface */
+    2,          /* endpoints excl 0: number of endpoint descriptors to follow */
+    0x0a,       /* interface class: data */
+    0,          /* interface subclass */
+    0,          /* interface protocol */
+    0,          /* string index for interface */
+/* data OUT endpoint: */
+    7,          /* sizeof(usbDescrEndpoint) */
+    USBDESCR_ENDPOINT,  /* descriptor type = endpoint */
+    0x01,       /* OUT endpoint number 1 */
+    CDC_DATA_ENDPOINT_TYPE, /* attrib: bulk or interrupt endpoint */
+    8, 0,       /* maximum packet size */
+    USB_CFG_INTR_POLL_INTERVAL, /* in ms, ignored for bulk */
+/* data IN endpoint: */
+    7,          /* sizeof(usbDescrEndpoint) */
+    USBDESCR_ENDPOINT,  /* descriptor type = endpoint */
+    (char)(0x80 | USB_CFG_EP3_NUMBER), /* IN endpoint number */
+    CDC_DATA_ENDPOINT_TYPE, /* attrib: bulk or interrupt endpoint */
+    8, 0,       /* maximum packet size */
+    USB_CFG_INTR_POLL_INTERVAL, /* in ms, ignored for bulk */
+};
+
+/* ------------------------------------------------------------------------- */
+/* ----------------------------- Ring Buffers ------------------------------ */
+/* ------------------------------------------------------------------------- */
+
+#define TX_MASK (CDC_TX_BUFFER_SIZE - 1)
+#define RX_MASK (CDC_RX_BUFFER_SIZE - 1)
+
+/* Head and tail are free running 8 bit counters, masked on access. Head is
+ * written by the producer only, tail by the consumer only.
+ */
+static uchar            txBuffer[CDC_TX_BUFFER_SIZE];
+static volatile uchar   txHead, txTail;
+static uchar            rxBuffer[CDC_RX_BUFFER_SIZE];
+static volatile uchar   rxHead, rxTail;
+
+cdcLineCoding_t         cdcLineCoding = {9600, 0, 0, 8};
+volatile uchar          cdcControlLineState;
+
+uchar   cdcTxFree(void)
+{
+    return CDC_TX_BUFFER_SIZE - (uchar)(txHead - txTail);
+}
+
+uchar   cdcRxAvailable(void)
+{
+    return rxHead - rxTail;
+}
+
+uchar   cdcPutc(uchar c)
+{
+uchar   head = txHead;
+
+    if((uchar)(head - txTail) >= CDC_TX_BUFFER_SIZE)
+        return 0;
+    txBuffer[head & TX_MASK] = c;
+    txHead = head + 1;
+    return 1;
+}
+
+uchar   cdcWrite(const uchar *data, uchar len)
+{
+uchar   i;
+
+    for(i = 0; i < len; i++){
+        if(!cdcPutc(data[i]))
+            break;
+    }
+    return i;
+}
+
+int     cdcGetc(void)
+{
+uchar   tail = rxTail, c;
+
+    if(tail == rxHead)
+        return -1;
+    c = rxBuffer[tail & RX_MASK];
+    rxTail = tail + 1;
+    return c;
+}
+
+uchar   cdcRead(uchar *data, uchar maxLen)
+{
+uchar   tail = rxTail, i;
+
+    for(i = 0; i < maxLen && tail != rxHead; i++){
+        data[i] = rxBuffer[tail++ & RX_MASK];
+    }
+    rxTail = tail;
+    return i;
+}
+
+/* ------------------------------------------------------------------------- */
+/* ----------------------------- USB interface ----------------------------- */
+/* ------------------------------------------------------------------------- */
+
+usbMsgLen_t usbFunctionSetup(uchar data[8])
+{
+usbRequest_t    *rq = (void *)data;
+
+    if((rq->bmRequestType & USBRQ_TYPE_MASK) == USBRQ_TYPE_CLASS){
+        if(rq->bRequest == CDC_GET_LINE_CODING){
+            usbMsgPtr = (usbMsgPtr_t)&cdcLineCoding;
+            return sizeof(cdcLineCoding);
+        }else if(rq->bRequest == CDC_SET_LINE_CODING){
+            return USB_NO_MSG;  /* data arrives in usbFunctionWrite() */
+        }else if(rq->bRequest == CDC_SET_CONTROL_LINE_STATE){
+            cdcControlLineState = rq->wValue.bytes[0];
+        }
+        /* CDC_SEND_BREAK is accepted and ignored */
+    }
+    return 0;
+}
+
+uchar   usbFunctionWrite(uchar *data, uchar len)
+{
+uchar   i, *p = (uchar *)&cdcLineCoding;
+
+    /* SET_LINE_CODING is the only control-out request we accept. Its 7 bytes
+     * fit into one packet.
+     */
+    for(i = 0; i < len && i < sizeof(cdcLineCoding); i++){
+        p[i] = data[i];
+    }
+    return 1;
+}
+
+void    usbFunctionWriteOut(uchar *data, uchar len)
+{
+uchar   head = rxHead;
+
+    while(len--){
+        rxBuffer[head++ & RX_MASK] = *data++;
+    }
+    rxHead = head;
+    /* NAK the next packet until it fits into the buffer, see cdcPoll() */
+    if(CDC_RX_BUFFER_SIZE - (uchar)(head - rxTail) < 8)
+        usbDisableAllRequests();
+}
+
+void    cdcPoll(void)
+{
+uchar   buffer[8], tail, len;
+
+    if(usbAllRequestsAreDisabled() && CDC_RX_BUFFER_SIZE - cdcRxAvailable() >= 8)
+        usbEnableAllRequests();
+    if(usbInterruptIsReady3()){
+        tail = txTail;
+        for(len = 0; len < 8 && tail != txHead; len++){
+            buffer[len] = txBuffer[tail++ & TX_MASK];
+        }
+        txTail = tail;
+        if(len > 0)
+            usbSetInterrupt3(buffer, len);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
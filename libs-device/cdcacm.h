@@ -0,0 +1,145 @@
+/* Name: cdcacm.h
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+General Description:
+This module implements a virtual serial port according to the USB
+Communication Device Class, Abstract Control Model (CDC-ACM). It provides
+the configuration descriptor with the class specific functional descriptors,
+handles the line coding and control line state requests and moves data
+between the USB endpoints and two ring buffers. Your firmware only calls
+cdcRead()/cdcWrite() (or cdcGetc()/cdcPutc()) and cdcPoll().
+
+Endpoints used:
+    endpoint 1 IN ....... interrupt, notifications (never sends data)
+    endpoint 1 OUT ...... data from host (received via usbFunctionWriteOut())
+    endpoint 3 IN ....... data to host (sent via usbSetInterrupt3())
+The data endpoints are declared as bulk endpoints by default. Strictly
+speaking, the USB specification forbids bulk endpoints for low speed
+devices. Linux converts them to interrupt endpoints (with a warning), other
+operating systems use them anyway (see the comment about bulk endpoints in
+usbdrv.h). Define CDC_DATA_ENDPOINT_TYPE to 3 for interrupt endpoints if
+your host requires spec conforming descriptors.
+
+Throughput:
+Data is always sent in full 8 byte packets while the transmit buffer holds
+enough data, and a new packet is prepared in the same cdcPoll() call which
+finds the endpoint ready. Incoming data is throttled with
+usbDisableAllRequests() when the receive buffer can't take another full
+packet, so that the host retries (NAK) instead of losing data. The
+examples/cdc-acm firmware contains a benchmark which measures the sustained
+rate in both directions with your host.
+
+Ring buffers:
+Both ring buffers have exactly one producer and one consumer and use 8 bit
+indices which are read and written atomically. Therefore cdcWrite() and
+cdcPutc() may be called from an interrupt handler (e.g. a UART receive
+interrupt) while cdcPoll() runs in the main loop, and cdcRead()/cdcGetc()
+may be called from an interrupt handler as well. Don't call the same
+function from both contexts.
+
+Usage:
+This module implements usbFunctionSetup(), usbFunctionWrite() and
+usbFunctionWriteOut() and provides usbDescriptorConfiguration. Your firmware
+must not define them. Include cdcacm.c in your main.c or compile it as a
+separate module and set the following options in usbconfig.h:
+
+#define USB_CFG_HAVE_INTRIN_ENDPOINT        1
+#define USB_CFG_HAVE_INTRIN_ENDPOINT3       1
+#define USB_CFG_EP3_NUMBER                  3
+#define USB_CFG_IMPLEMENT_FN_WRITE          1
+#define USB_CFG_IMPLEMENT_FN_WRITEOUT       1
+#define USB_CFG_HAVE_FLOWCONTROL            1
+#define USB_CFG_DEVICE_ID                   0xe1, 0x05  // shared PID for CDC-ACM
+#define USB_CFG_DEVICE_CLASS                2
+#define USB_CFG_DEVICE_SUBCLASS             0
+#define USB_CFG_DESCR_PROPS_CONFIGURATION   USB_PROP_LENGTH(67)
+
+The length of 67 bytes is CDC_CONFIG_DESCRIPTOR_LENGTH below. Call
+cdcPoll() from the main loop after each usbPoll().
+*/
+
+#ifndef __CDCACM_H_INCLUDED__
+#define __CDCACM_H_INCLUDED__
+
+#ifndef uchar
+#define uchar   unsigned char
+#endif
+
+#ifndef CDC_TX_BUFFER_SIZE
+#define CDC_TX_BUFFER_SIZE      32
+#endif
+/* Size of the buffer for data sent to the host. Must be a power of 2 between
+ * 16 and 128.
+ */
+#ifndef CDC_RX_BUFFER_SIZE
+#define CDC_RX_BUFFER_SIZE      32
+#endif
+/* Size of the buffer for data received from the host. Must be a power of 2
+ * between 16 and 128.
+ */
+#ifndef CDC_DATA_ENDPOINT_TYPE
+#define CDC_DATA_ENDPOINT_TYPE  2
+#endif
+/* Endpoint type of the data endpoints: 2 for bulk, 3 for interrupt. */
+
+#define CDC_CONFIG_DESCRIPTOR_LENGTH    67
+/* Value for USB_PROP_LENGTH() in USB_CFG_DESCR_PROPS_CONFIGURATION. */
+
+/* CDC class requests */
+#define CDC_SET_LINE_CODING         0x20
+#define CDC_GET_LINE_CODING         0x21
+#define CDC_SET_CONTROL_LINE_STATE  0x22
+#define CDC_SEND_BREAK              0x23
+
+/* bits in cdcControlLineState */
+#define CDC_CONTROL_DTR     1
+#define CDC_CONTROL_RTS     2
+
+typedef struct cdcLineCoding{
+    unsigned long   dwDTERate;      /* baud rate, little endian */
+    uchar           bCharFormat;    /* 0 = 1 stop bit, 1 = 1.5, 2 = 2 */
+    uchar           bParityType;    /* 0 = none, 1 = odd, 2 = even, 3 = mark, 4 = space */
+    uchar           bDataBits;      /* 5, 6, 7, 8 or 16 */
+}cdcLineCoding_t;
+
+extern cdcLineCoding_t  cdcLineCoding;
+/* The line coding most recently set by the host. The default is 9600 baud,
+ * 8 data bits, no parity, 1 stop bit. Firmware which forwards data to a
+ * real UART can configure the UART from this structure.
+ */
+extern volatile uchar   cdcControlLineState;
+/* DTR and RTS as set by the host, see CDC_CONTROL_* above. Most terminal
+ * programs set DTR when they open the port.
+ */
+
+void    cdcPoll(void);
+/* Call this function from the main loop after each usbPoll(). It sends the
+ * next packet from the transmit buffer and releases flow control when the
+ * receive buffer has room for another packet.
+ */
+uchar   cdcWrite(const uchar *data, uchar len);
+/* Append up to 'len' bytes to the transmit buffer. Returns the number of
+ * bytes actually queued, which is less than 'len' if the buffer is full.
+ */
+uchar   cdcPutc(uchar c);
+/* Append one byte to the transmit buffer. Returns 0 if the buffer is full
+ * and 1 otherwise.
+ */
+uchar   cdcRead(uchar *data, uchar maxLen);
+/* Copy up to 'maxLen' received bytes to 'data'. Returns the number of bytes
+ * copied, 0 if nothing was received.
+ */
+int     cdcGetc(void);
+/* Returns the next received byte or -1 if the receive buffer is empty. */
+uchar   cdcTxFree(void);
+/* Returns the number of bytes which can be queued with cdcWrite(). */
+uchar   cdcRxAvailable(void);
+/* Returns the number of bytes which can be read with cdcRead(). */
+
+#endif /* __CDCACM_H_INCLUDED__ */
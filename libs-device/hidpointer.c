@@ -0,0 +1,98 @@
+/* Name: hidpointer.c
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "hidpointer.h"
+
+/* ------------------------------------------------------------------------- */
+/* ------------------------- Pointer Accumulator --------------------------- */
+/* ------------------------------------------------------------------------- */
+
+static int              pointerAccu[3];     /* x, y, wheel */
+static uchar            pointerButtons;     /* state sent in last report */
+static uchar            pointerQueue[POINTER_BUTTON_QUEUE_SIZE];
+static volatile uchar   pointerQueueLen;
+
+static int  addSaturated(int accu, int delta)
+{
+    if(delta > 0){
+        if(accu > 32767 - delta)
+            return 32767;
+    }else{
+        if(accu < -32767 - delta)
+            return -32767;
+    }
+    return accu + delta;
+}
+
+void    pointerMove(int dx, int dy, int dWheel)
+{
+uchar   sreg = SREG;
+
+    cli();
+    pointerAccu[0] = addSaturated(pointerAccu[0], dx);
+    pointerAccu[1] = addSaturated(pointerAccu[1], dy);
+    pointerAccu[2] = addSaturated(pointerAccu[2], dWheel);
+    SREG = sreg;
+}
+
+void    pointerSetButtons(uchar buttonMask)
+{
+uchar   sreg = SREG, len;
+
+    cli();
+    len = pointerQueueLen;
+    if(buttonMask != (len == 0 ? pointerButtons : pointerQueue[len - 1])){
+        if(len >= POINTER_BUTTON_QUEUE_SIZE)
+            len--;  /* queue full: merge with the last queued state */
+        pointerQueue[len++] = buttonMask;
+        pointerQueueLen = len;
+    }
+    SREG = sreg;
+}
+
+/* Take at most +/-127 out of an accumulator. Must be called with interrupts
+ * disabled.
+ */
+static signed char  takeChunk(int *accu)
+{
+int     chunk = *accu;
+
+    if(chunk > 127){
+        chunk = 127;
+    }else if(chunk < -127){
+        chunk = -127;
+    }
+    *accu -= chunk;
+    return chunk;
+}
+
+uchar   pointerBuildReport(uchar *report)
+{
+uchar   sreg = SREG, i, changed = 0;
+
+    cli();
+    if(pointerQueueLen > 0){
+        pointerButtons = pointerQueue[0];
+        for(i = 1; i < pointerQueueLen; i++){
+            pointerQueue[i - 1] = pointerQueue[i];
+        }
+        pointerQueueLen--;
+        changed = 1;
+    }
+    report[0] = pointerButtons;
+    for(i = 0; i < 3; i++){
+        if((report[i + 1] = takeChunk(&pointerAccu[i])) != 0)
+            changed = 1;
+    }
+    SREG = sreg;
+    return changed;
+}
+
+/* ------------------------------------------------------------------------- */
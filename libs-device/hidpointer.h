@@ -0,0 +1,81 @@
+/* Name: hidpointer.h
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+General Description:
+This module decouples the rate at which a pointing device produces motion
+from the rate at which the host polls the interrupt endpoint. Sensors such
+as optical mice, trackballs or rotary encoders often deliver far more (and
+far larger) movements per millisecond than fit into the 8 bit deltas of a
+single HID report. Instead of writing every sample into the report buffer
+(and losing all samples which arrive before the host fetched the previous
+report), feed all movements into pointerMove() and all button states into
+pointerSetButtons(). Whenever the interrupt endpoint is ready, call
+pointerBuildReport() to obtain the next report.
+
+Motion is summed up in 16 bit accumulators (saturating, not wrapping) and
+paid out in chunks of at most +/-127 per report, so no movement is lost
+and large movements are spread over as many reports as necessary. Button
+changes are queued: a press and release which both happen between two
+interrupt polls still result in two reports, so that fast clicks are not
+swallowed. Motion accumulated so far is sent along with the next report,
+regardless of the order of motion and button changes.
+
+The report built by pointerBuildReport() has the layout of a wheel mouse:
+    byte 0 ... button states (bit 0 = button 1 etc.)
+    byte 1 ... 8 bit signed relative X
+    byte 2 ... 8 bit signed relative Y
+    byte 3 ... 8 bit signed relative wheel
+This matches the report descriptor in the hid-mouse example.
+
+pointerMove() and pointerSetButtons() may be called from interrupt
+handlers. pointerBuildReport() disables interrupts for a couple of cycles
+while it takes the next chunk out of the accumulators.
+
+Usage:
+Define POINTER_BUTTON_QUEUE_SIZE (see below) if you need a deeper queue
+for button changes, then include hidpointer.c in your main.c or compile it
+as a separate module.
+*/
+
+#ifndef __HIDPOINTER_H_INCLUDED__
+#define __HIDPOINTER_H_INCLUDED__
+
+#ifndef uchar
+#define uchar   unsigned char
+#endif
+
+#ifndef POINTER_BUTTON_QUEUE_SIZE
+#define POINTER_BUTTON_QUEUE_SIZE   4
+#endif
+/* Number of button state changes which can be queued between two interrupt
+ * polls. If more changes arrive, the last queued state is replaced by the
+ * newest one. Each entry costs one byte of RAM.
+ */
+
+#define POINTER_REPORT_SIZE         4
+/* Size of the report built by pointerBuildReport(). */
+
+void    pointerMove(int dx, int dy, int dWheel);
+/* Add a relative movement to the accumulators. Positive dx is to the right,
+ * positive dy is downwards and positive dWheel scrolls up. Accumulators
+ * saturate at +/-32767 if the host does not fetch reports (e.g. while the
+ * bus is suspended).
+ */
+void    pointerSetButtons(uchar buttonMask);
+/* Report the current state of all buttons. Calls with an unchanged state
+ * are ignored, so you may call this function with every sensor sample.
+ */
+uchar   pointerBuildReport(uchar *report);
+/* Build the next report into 'report' (POINTER_REPORT_SIZE bytes). The
+ * return value is non-zero if the report contains a button change or
+ * motion, and zero if the pointer is idle. You don't need to send idle
+ * reports, but the buffer is filled in either case.
+ */
+
+#endif /* __HIDPOINTER_H_INCLUDED__ */
@@ -0,0 +1,160 @@
+/* Name: keyqueue.c
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+#include <avr/pgmspace.h>
+#include "keyqueue.h"
+
+#define KEYQUEUE_MASK   (KEYQUEUE_SIZE - 1)
+
+/* ------------------------------------------------------------------------- */
+/* ---------------------------- ASCII to keycode --------------------------- */
+/* ------------------------------------------------------------------------- */
+
+/* Keycodes (usage page 7) for ASCII 0x20 to 0x7e on a US keyboard layout.
+ * Bit 7 is set for characters which require the Shift modifier.
+ */
+static PROGMEM const uchar asciiToKeycode[95] = {
+    0x2c, 0x9e, 0xb4, 0xa0, 0xa1, 0xa2, 0xa4, 0x34,    /* SP ! " # $ % & ' */
+    0xa6, 0xa7, 0xa5, 0xae, 0x36, 0x2d, 0x37, 0x38,    /* ( ) * + , - . / */
+    0x27, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24,    /* 0 1 2 3 4 5 6 7 */
+    0x25, 0x26, 0xb3, 0x33, 0xb6, 0x2e, 0xb7, 0xb8,    /* 8 9 : ; < = > ? */
+    0x9f, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a,    /* @ A B C D E F G */
+    0x8b, 0x8c, 0x8d, 0x8e, 0x8f, 0x90, 0x91, 0x92,    /* H I J K L M N O */
+    0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a,    /* P Q R S T U V W */
+    0x9b, 0x9c, 0x9d, 0x2f, 0x31, 0x30, 0xa3, 0xad,    /* X Y Z [ \ ] ^ _ */
+    0x35, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,    /* ` a b c d e f g */
+    0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12,    /* h i j k l m n o */
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a,    /* p q r s t u v w */
+    0x1b, 0x1c, 0x1d, 0xaf, 0xb1, 0xb0, 0xb5,          /* x y z { | } ~ */
+};
+
+/* ------------------------------------------------------------------------- */
+/* ----------------------------- Keystroke Queue --------------------------- */
+/* ------------------------------------------------------------------------- */
+
+static uchar        queueModifier[KEYQUEUE_SIZE];
+static uchar        queueKeycode[KEYQUEUE_SIZE];
+static uchar        queueHead, queueTail;   /* free running, masked on access */
+static const char   *macroPtr;              /* flash address of playing macro */
+static uchar        lastKeys[KEYQUEUE_KEYS_PER_REPORT]; /* keys held down */
+static uchar        lastKeyCount, lastModifier;
+
+uchar   keyQueueFree(void)
+{
+    return KEYQUEUE_SIZE - (uchar)(queueHead - queueTail);
+}
+
+uchar   keyQueuePut(uchar modifier, uchar keycode)
+{
+uchar   i;
+
+    if(keyQueueFree() == 0)
+        return 0;
+    i = queueHead & KEYQUEUE_MASK;
+    queueModifier[i] = modifier;
+    queueKeycode[i] = keycode;
+    queueHead++;
+    return 1;
+}
+
+uchar   keyQueuePutChar(char c)
+{
+uchar   k;
+
+    if(c == '\n'){
+        k = 0x28;   /* Enter */
+    }else if(c == '\t'){
+        k = 0x2b;   /* Tab */
+    }else if(c == '\b'){
+        k = 0x2a;   /* Backspace */
+    }else if(c >= 0x20 && c <= 0x7e){
+        k = pgm_read_byte(&asciiToKeycode[c - 0x20]);
+    }else{
+        return 1;   /* not typeable, ignore */
+    }
+    return keyQueuePut(k & 0x80 ? KEYQUEUE_MOD_SHIFT : 0, k & 0x7f);
+}
+
+void    keyQueuePlay_P(const char *str)
+{
+    macroPtr = str;
+}
+
+/* Move characters from the playing macro into the queue while there is room,
+ * keeping KEYQUEUE_MACRO_RESERVE entries for other sources.
+ */
+static void feedMacro(void)
+{
+char    c;
+
+    while(macroPtr != 0 && keyQueueFree() > KEYQUEUE_MACRO_RESERVE){
+        c = pgm_read_byte(macroPtr);
+        if(c == 0){
+            macroPtr = 0;
+            break;
+        }
+        macroPtr++;
+        keyQueuePutChar(c);
+    }
+}
+
+static uchar    containsKey(uchar *keys, uchar count, uchar keycode)
+{
+    while(count--){
+        if(*keys++ == keycode)
+            return 1;
+    }
+    return 0;
+}
+
+uchar   keyQueueBuildReport(uchar *report)
+{
+uchar   i, n = 0, modifier, keycode;
+
+    feedMacro();
+    for(i = 0; i < KEYQUEUE_REPORT_SIZE; i++){
+        report[i] = 0;
+    }
+    if(queueHead != queueTail){
+        i = queueTail & KEYQUEUE_MASK;
+        modifier = queueModifier[i];
+        if(queueKeycode[i] == 0){   /* modifier only */
+            queueTail++;
+            report[0] = modifier;
+        }else{
+            do{
+                i = queueTail & KEYQUEUE_MASK;
+                keycode = queueKeycode[i];
+                if(queueModifier[i] != modifier || keycode == 0)
+                    break;  /* needs a different modifier: next report */
+                if(containsKey(&report[2], n, keycode) || containsKey(lastKeys, lastKeyCount, keycode))
+                    break;  /* repeated key: must be released first */
+                report[2 + n++] = keycode;
+                queueTail++;
+            }while(queueHead != queueTail && n < KEYQUEUE_KEYS_PER_REPORT);
+            /* If n is 0, the first key is still held down from the previous
+             * report and this becomes a release report.
+             */
+            if(n > 0)
+                report[0] = modifier;
+        }
+        for(i = 0; i < n; i++){
+            lastKeys[i] = report[2 + i];
+        }
+        lastKeyCount = n;
+        lastModifier = report[0];
+        return 1;
+    }
+    if(lastKeyCount == 0 && lastModifier == 0)
+        return 0;   /* everything released, nothing to do */
+    lastKeyCount = 0;
+    lastModifier = 0;
+    return 1;       /* release all keys */
+}
+
+/* ------------------------------------------------------------------------- */
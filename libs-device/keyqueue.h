@@ -0,0 +1,103 @@
+/* Name: keyqueue.h
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+General Description:
+This module implements a keystroke queue for HID keyboards which types text
+as fast as the host polls the interrupt endpoint. The simple approach of
+sending one key press and one key release per character needs two interrupt
+polls per character. This module packs up to 6 distinct keys into one
+report instead (the boot protocol keyboard report has 6 key slots) and
+inserts a release report only where it is really needed: when a key must be
+pressed again which is still held down in the previous report. Keys which
+need a different modifier (e.g. Shift) start a new report.
+
+The host processes newly pressed keys of a report in the order of the key
+slots. All major operating systems do so, but if you see characters in the
+wrong order with your host, define KEYQUEUE_KEYS_PER_REPORT to 1. This
+falls back to one key per report, still without release reports in between
+for distinct characters.
+
+Keystrokes can be queued as (modifier, keycode) pairs, as ASCII characters
+(US keyboard layout) or as a string in flash memory. Flash strings are not
+copied into the queue at once: they are fed in as the queue drains, so that
+macros of any length need no RAM.
+
+The report built by keyQueueBuildReport() has the layout of the boot protocol
+keyboard report:
+    byte 0 ....... modifier bits (bit 0 = left Ctrl, bit 1 = left Shift etc.)
+    byte 1 ....... reserved, always 0
+    bytes 2..7 ... key codes (usage page 7) of pressed keys
+
+All functions of this module must be called from the main loop (e.g. from
+usbFunctionWrite()), not from interrupt handlers.
+
+Usage:
+Include keyqueue.c in your main.c or compile it as a separate module. Call
+keyQueueBuildReport() whenever usbInterruptIsReady() and send the report if
+the function returns non-zero.
+*/
+
+#ifndef __KEYQUEUE_H_INCLUDED__
+#define __KEYQUEUE_H_INCLUDED__
+
+#ifndef uchar
+#define uchar   unsigned char
+#endif
+
+#ifndef KEYQUEUE_SIZE
+#define KEYQUEUE_SIZE               32
+#endif
+/* Number of keystrokes the queue can hold. Must be a power of 2 and not
+ * more than 128. Each entry costs two bytes of RAM.
+ */
+#ifndef KEYQUEUE_KEYS_PER_REPORT
+#define KEYQUEUE_KEYS_PER_REPORT    6
+#endif
+/* Maximum number of newly pressed keys in one report (1 to 6). */
+#ifndef KEYQUEUE_MACRO_RESERVE
+#define KEYQUEUE_MACRO_RESERVE      8
+#endif
+/* Number of entries a playing macro leaves free for keystrokes from other
+ * sources, e.g. text received in 8 byte packets from the host. Set it to 0
+ * if macros are the only source.
+ */
+
+#define KEYQUEUE_REPORT_SIZE        8
+/* Size of the report built by keyQueueBuildReport(). */
+
+#define KEYQUEUE_MOD_SHIFT          0x02
+/* Modifier bit used for shifted ASCII characters (left Shift). */
+
+uchar   keyQueuePut(uchar modifier, uchar keycode);
+/* Append a keystroke with the given modifier bits and keycode. Returns 0 if
+ * the queue is full and 1 if the keystroke was queued.
+ */
+uchar   keyQueuePutChar(char c);
+/* Append the keystroke which types the ASCII character c on a US keyboard
+ * layout. Besides the printable characters, '\n' (Enter), '\t' (Tab) and
+ * '\b' (Backspace) are supported, other characters are ignored. Returns 0 if
+ * the queue is full and 1 otherwise.
+ */
+void    keyQueuePlay_P(const char *str);
+/* Type the zero terminated string 'str' which is stored in flash memory
+ * (PROGMEM). Characters are translated as with keyQueuePutChar(). A macro
+ * which is still playing is aborted. The macro is fed into the queue while
+ * more than KEYQUEUE_MACRO_RESERVE entries are free.
+ */
+uchar   keyQueueFree(void);
+/* Returns the number of keystrokes which can still be queued. This can be
+ * used for flow control, e.g. with usbDisableAllRequests().
+ */
+uchar   keyQueueBuildReport(uchar *report);
+/* Build the next report into 'report' (KEYQUEUE_REPORT_SIZE bytes). Returns
+ * non-zero if the report must be sent and zero if there is nothing to type
+ * and all keys have already been released.
+ */
+
+#endif /* __KEYQUEUE_H_INCLUDED__ */
@@ -0,0 +1,62 @@
+/* Name: softime.c
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "usbdrv.h"
+#include "softime.h"
+
+#if !USB_COUNT_SOF
+#error "softime.c requires USB_COUNT_SOF"
+#endif
+
+#if SOFTIME_PRESCALING == 1
+#   define SOFTIME_CLOCK_SELECT 1
+#elif SOFTIME_PRESCALING == 8
+#   define SOFTIME_CLOCK_SELECT 2
+#elif SOFTIME_PRESCALING == 64
+#   define SOFTIME_CLOCK_SELECT 3
+#else
+#   error "SOFTIME_PRESCALING must be 1, 8 or 64"
+#endif
+
+volatile unsigned short softimeSofTimer;
+
+void    softimeInit(void)
+{
+    TCCR1B = SOFTIME_CLOCK_SELECT;  /* normal mode, CS12..CS10 select the prescaler */
+}
+
+unsigned short  softimeTimer(void)
+{
+uchar           sreg = SREG;
+unsigned short  value;
+
+    cli();
+    value = TCNT1;
+    SREG = sreg;
+    return value;
+}
+
+void    softimeStamp(uchar *stamp)
+{
+uchar           sreg = SREG, sof;
+unsigned short  ticks;
+
+    /* The SOF count and the timer value captured with it must be consistent.
+     * If an SOF occurs while interrupts are disabled, both still refer to the
+     * previous frame and the tick count is correspondingly larger.
+     */
+    cli();
+    ticks = TCNT1 - softimeSofTimer;
+    sof = usbSofCount;
+    SREG = sreg;
+    stamp[0] = sof;
+    stamp[1] = ticks;
+    stamp[2] = ticks >> 8;
+}
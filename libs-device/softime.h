@@ -0,0 +1,91 @@
+/* Name: softime.h
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+General Description:
+This module provides a time base which is synchronized to the USB frame
+clock of the host. A timestamp consists of the number of the most recent
+Start Of Frame (usbSofCount) and the number of Timer 1 ticks since this SOF.
+Since the host generates SOF exactly every millisecond, the host can convert
+timestamps to its own time scale, e.g. to measure the latency of interrupt
+transfers. See examples/latency for a host tool which does that.
+
+This file must be included from usbconfig.h because it defines
+USB_SOF_HOOK. The hook captures Timer 1 whenever an SOF is detected.
+softime.c contains the C functions.
+
+Notes:
+(*) You must define USB_COUNT_SOF to 1 in usbconfig.h, and D- must be wired
+to the interrupt, not D+!!!
+
+(*) Timer 1 must be free running (not written by your code) and the
+prescaling must be consistent with SOFTIME_PRESCALING. softimeInit() starts
+the timer accordingly.
+
+(*) The hook reads the 16 bit timer register in the interrupt and thus
+overwrites the AVR's shared TEMP register. If your code reads TCNT1 or other
+16 bit registers of Timer 1 while interrupts are enabled, the high byte may
+be wrong. Use softimeTimer() instead or disable interrupts around the access.
+
+(*) The hook adds 12 cycles after each SOF. As with osctune.h, a message
+immediately after the SOF may therefore be lost and must be retried by the
+host.
+*/
+
+#ifndef __SOFTIME_H_INCLUDED__
+#define __SOFTIME_H_INCLUDED__
+
+#ifndef SOFTIME_PRESCALING
+#define SOFTIME_PRESCALING      8   /* 1, 8 or 64 */
+#endif
+/* derived constants: */
+#define SOFTIME_TICKS_PER_MS    (F_CPU / (1000 * SOFTIME_PRESCALING))
+
+#ifdef __ASSEMBLER__
+macro captureSofTime
+    push    YH                              ;[0]
+#if TCNT1L > 0x3f   /* outside I/O addressable range */
+    lds     YL, TCNT1L                      ;[2] reading the low byte latches the high byte
+    lds     YH, TCNT1H                      ;[4]
+#else
+    in      YL, TCNT1L                      ;[2] reading the low byte latches the high byte
+    in      YH, TCNT1H                      ;[3]
+#endif
+    sts     softimeSofTimer, YL             ;[6]
+    sts     softimeSofTimer+1, YH           ;[8]
+    pop     YH                              ;[10]
+    endm                                    ;[12] max number of cycles
+#else   /* __ASSEMBLER__ */
+
+#ifndef uchar
+#define uchar   unsigned char
+#endif
+
+extern volatile unsigned short  softimeSofTimer;
+/* Value of Timer 1 at the most recent SOF, written by the hook. */
+
+void            softimeInit(void);
+/* Start Timer 1 with the prescaling given by SOFTIME_PRESCALING. Call this
+ * function before interrupts are enabled.
+ */
+unsigned short  softimeTimer(void);
+/* Returns the current value of Timer 1, read with interrupts disabled. */
+void            softimeStamp(uchar *stamp);
+/* Stores the current time in 3 bytes at 'stamp': the SOF count in stamp[0],
+ * followed by the number of timer ticks since this SOF as 16 bit little
+ * endian value. The tick count may exceed SOFTIME_TICKS_PER_MS if an SOF was
+ * missed, e.g. because interrupts were disabled for too long. The host
+ * computes the time as stamp[0] milliseconds (modulo 256) plus ticks divided
+ * by SOFTIME_TICKS_PER_MS milliseconds.
+ */
+
+#endif  /* __ASSEMBLER__ */
+
+#define USB_SOF_HOOK        captureSofTime
+
+#endif /* __SOFTIME_H_INCLUDED__ */
@@ -0,0 +1,280 @@
+/* Name: usbdescriptors.hpp
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+General Description:
+This header is for firmware written in C++ (avr-g++ 4.7 or newer with
+-std=gnu++11). It composes USB descriptors from constexpr objects, so that
+all lengths and counts are computed by the compiler:
+
+  - bLength of every descriptor,
+  - wTotalLength and bNumInterfaces of the configuration descriptor,
+  - bNumEndpoints of each interface descriptor,
+  - wDescriptorLength of the HID descriptor (pass sizeof() of the report),
+  - the header of string descriptors (USB_STRING_DESCRIPTOR_HEADER).
+
+USB_DESCRIPTOR() places the result in flash memory under the name the driver
+expects. The objects are constant initialized, so they cost exactly as much
+flash memory as the equivalent C arrays and neither code nor RAM. This
+allows static descriptors for composite devices and other configurations
+which the driver's default descriptors don't cover, without resorting to
+USB_PROP_IS_DYNAMIC and usbFunctionDescriptor().
+
+Usage:
+In usbconfig.h, declare the descriptors as static with their length, e.g.
+    #define USB_CFG_DESCR_PROPS_CONFIGURATION   USB_PROP_LENGTH(59)
+The length must be known to the preprocessor in usbdrv.c, which is compiled
+as C. USB_DESCRIPTOR() checks it at compile time, so a wrong value is an
+error, not a malfunction. In one C++ module:
+
+    #include "usbdrv.h"
+    #include "usbdescriptors.hpp"
+
+    PROGMEM const char usbDescriptorHidReport[52] = { ... };
+
+    USB_DESCRIPTOR(usbDescriptorConfiguration, USB_CFG_DESCR_PROPS_CONFIGURATION,
+        usbdesc::configuration(
+            usbdesc::interface(0, 3, 0, 0, 0,   // HID, no boot protocol
+                usbdesc::Hid(sizeof(usbDescriptorHidReport)),
+                usbdesc::Endpoint(usbdesc::IN | 1, usbdesc::INTERRUPT, 10)),
+            usbdesc::interface(1, 0xff, 0, 0, 0,
+                usbdesc::Endpoint(usbdesc::IN | 3, usbdesc::BULK, 0))));
+    USB_DESCRIPTOR(usbDescriptorStringDevice, USB_CFG_DESCR_PROPS_STRING_PRODUCT,
+        usbdesc::string("Mouse"));
+
+Note that the driver answers HID descriptor requests with the 9 bytes at
+offset 18 of the configuration descriptor. A HID descriptor must therefore
+immediately follow the first interface descriptor.
+*/
+
+#ifndef __USBDESCRIPTORS_HPP_INCLUDED__
+#define __USBDESCRIPTORS_HPP_INCLUDED__
+
+#ifndef __cplusplus
+#error "usbdescriptors.hpp requires C++"
+#endif
+
+#include "usbdrv.h"
+
+#define USB_DESCRIPTOR(name, props, value)                                      \
+    extern PROGMEM constexpr decltype(value) name##Descriptor asm(#name) = value; \
+    static_assert((props) == USB_PROP_LENGTH(sizeof(name##Descriptor)),        \
+        #props " must be USB_PROP_LENGTH(sizeof(" #name "))")
+/* Defines 'name' as descriptor in flash memory, e.g. usbDescriptorDevice or
+ * usbDescriptorConfiguration. The symbol has the name the driver expects,
+ * the object itself can be accessed as nameDescriptor from C++ code. 'props'
+ * is the corresponding USB_CFG_DESCR_PROPS_* value from usbconfig.h, which
+ * must be USB_PROP_LENGTH() of the object's size.
+ */
+
+namespace usbdesc{
+
+enum{
+    OUT         = 0x00, /* endpoint address direction bits */
+    IN          = 0x80,
+    BULK        = 2,    /* endpoint transfer types */
+    INTERRUPT   = 3,
+};
+
+#if USB_CFG_DESCR_PROPS_STRING_VENDOR || USB_CFG_VENDOR_NAME_LEN
+constexpr uchar stringVendor = 1;
+#else
+constexpr uchar stringVendor = 0;
+#endif
+#if USB_CFG_DESCR_PROPS_STRING_PRODUCT || USB_CFG_DEVICE_NAME_LEN
+constexpr uchar stringProduct = 2;
+#else
+constexpr uchar stringProduct = 0;
+#endif
+#if USB_CFG_DESCR_PROPS_STRING_SERIAL_NUMBER || USB_CFG_SERIAL_NUMBER_LEN
+constexpr uchar stringSerialNumber = 3;
+#else
+constexpr uchar stringSerialNumber = 0;
+#endif
+/* String indices in the device descriptor, same as in the driver's default
+ * device descriptor.
+ */
+
+/* ------------------------------------------------------------------------- */
+
+struct __attribute__((packed)) Word{
+    uchar   lo, hi;
+    constexpr Word(unsigned value) : lo(value & 0xff), hi((value >> 8) & 0xff) {}
+    constexpr Word(uchar low, uchar high) : lo(low), hi(high) {}
+};
+/* 16 bit value in USB byte order. The second constructor takes the byte
+ * lists of usbconfig.h, e.g. Word(USB_CFG_VENDOR_ID).
+ */
+
+template<typename T, typename... Rest>
+struct __attribute__((packed)) List{
+    T               first;
+    List<Rest...>   rest;
+    static constexpr uchar numInterfaces = T::numInterfaces + List<Rest...>::numInterfaces;
+    static constexpr uchar numEndpoints = T::numEndpoints + List<Rest...>::numEndpoints;
+    constexpr List(const T &f, const Rest &... r) : first(f), rest(r...) {}
+};
+
+template<typename T>
+struct __attribute__((packed)) List<T>{
+    T               first;
+    static constexpr uchar numInterfaces = T::numInterfaces;
+    static constexpr uchar numEndpoints = T::numEndpoints;
+    constexpr List(const T &f) : first(f) {}
+};
+/* Sequence of descriptors without padding. Each element type declares how
+ * many interface and endpoint descriptors it contains.
+ */
+
+/* ------------------------------------------------------------------------- */
+
+struct __attribute__((packed)) Device{
+    uchar   bLength, bDescriptorType;
+    Word    bcdUSB;
+    uchar   bDeviceClass, bDeviceSubClass, bDeviceProtocol, bMaxPacketSize0;
+    Word    idVendor, idProduct, bcdDevice;
+    uchar   iManufacturer, iProduct, iSerialNumber, bNumConfigurations;
+    constexpr Device(Word vendorId = Word(USB_CFG_VENDOR_ID), Word productId = Word(USB_CFG_DEVICE_ID),
+                     Word version = Word(USB_CFG_DEVICE_VERSION), uchar deviceClass = USB_CFG_DEVICE_CLASS,
+                     uchar subClass = USB_CFG_DEVICE_SUBCLASS, uchar protocol = 0)
+        : bLength(sizeof(Device)), bDescriptorType(USBDESCR_DEVICE), bcdUSB(0x0110),
+          bDeviceClass(deviceClass), bDeviceSubClass(subClass), bDeviceProtocol(protocol), bMaxPacketSize0(8),
+          idVendor(vendorId), idProduct(productId), bcdDevice(version),
+          iManufacturer(stringVendor), iProduct(stringProduct), iSerialNumber(stringSerialNumber),
+          bNumConfigurations(1) {}
+};
+/* Device descriptor. The defaults are taken from usbconfig.h. */
+
+template<typename... Parts>
+struct __attribute__((packed)) Configuration{
+    uchar           bLength, bDescriptorType;
+    Word            wTotalLength;
+    uchar           bNumInterfaces, bConfigurationValue, iConfiguration, bmAttributes, bMaxPower;
+    List<Parts...>  parts;
+    constexpr Configuration(const Parts &... p)
+        : bLength(9), bDescriptorType(USBDESCR_CONFIG), wTotalLength(sizeof(Configuration)),
+          bNumInterfaces(List<Parts...>::numInterfaces), bConfigurationValue(1),
+          iConfiguration(USB_CFG_CONFIGURATION_STRING),
+          bmAttributes((1 << 7) | (USB_CFG_IS_SELF_POWERED ? USBATTR_SELFPOWER : USBATTR_REMOTEWAKE)),
+          bMaxPower(USB_CFG_MAX_BUS_POWER / 2), parts(p...) {}
+};
+
+template<typename... Parts>
+constexpr Configuration<Parts...> configuration(const Parts &... p)
+{
+    return Configuration<Parts...>(p...);
+}
+/* Configuration descriptor followed by all interfaces (and other descriptors
+ * in 'p'). Attributes and power are taken from usbconfig.h, as in the
+ * driver's default configuration descriptor.
+ */
+
+struct __attribute__((packed)) InterfaceHeader{
+    uchar   bLength, bDescriptorType, bInterfaceNumber, bAlternateSetting, bNumEndpoints;
+    uchar   bInterfaceClass, bInterfaceSubClass, bInterfaceProtocol, iInterface;
+    static constexpr uchar numInterfaces = 1;
+    static constexpr uchar numEndpoints = 0;    /* counted in bNumEndpoints */
+    constexpr InterfaceHeader(uchar number, uchar interfaceClass, uchar subClass, uchar protocol,
+                              uchar stringIndex, uchar endpoints)
+        : bLength(sizeof(InterfaceHeader)), bDescriptorType(USBDESCR_INTERFACE), bInterfaceNumber(number),
+          bAlternateSetting(0), bNumEndpoints(endpoints), bInterfaceClass(interfaceClass),
+          bInterfaceSubClass(subClass), bInterfaceProtocol(protocol), iInterface(stringIndex) {}
+};
+
+template<typename... Parts>
+struct __attribute__((packed)) Interface : InterfaceHeader{
+    List<Parts...>  parts;
+    constexpr Interface(uchar number, uchar interfaceClass, uchar subClass, uchar protocol,
+                        uchar stringIndex, const Parts &... p)
+        : InterfaceHeader(number, interfaceClass, subClass, protocol, stringIndex, List<Parts...>::numEndpoints),
+          parts(p...) {}
+};
+
+template<>
+struct __attribute__((packed)) Interface<> : InterfaceHeader{
+    constexpr Interface(uchar number, uchar interfaceClass, uchar subClass, uchar protocol, uchar stringIndex)
+        : InterfaceHeader(number, interfaceClass, subClass, protocol, stringIndex, 0) {}
+};
+
+template<typename... Parts>
+constexpr Interface<Parts...> interface(uchar number, uchar interfaceClass, uchar subClass, uchar protocol,
+                                        uchar stringIndex, const Parts &... p)
+{
+    return Interface<Parts...>(number, interfaceClass, subClass, protocol, stringIndex, p...);
+}
+/* Interface descriptor followed by class descriptors and endpoints in 'p'. */
+
+struct __attribute__((packed)) Hid{
+    uchar   bLength, bDescriptorType;
+    Word    bcdHID;
+    uchar   bCountryCode, bNumDescriptors, bReportDescriptorType;
+    Word    wDescriptorLength;
+    static constexpr uchar numInterfaces = 0;
+    static constexpr uchar numEndpoints = 0;
+    constexpr Hid(unsigned reportLength)
+        : bLength(sizeof(Hid)), bDescriptorType(USBDESCR_HID), bcdHID(0x0101), bCountryCode(0),
+          bNumDescriptors(1), bReportDescriptorType(USBDESCR_HID_REPORT), wDescriptorLength(reportLength) {}
+};
+/* HID class descriptor with one report descriptor of 'reportLength' bytes. */
+
+struct __attribute__((packed)) Endpoint{
+    uchar   bLength, bDescriptorType, bEndpointAddress, bmAttributes;
+    Word    wMaxPacketSize;
+    uchar   bInterval;
+    static constexpr uchar numInterfaces = 0;
+    static constexpr uchar numEndpoints = 1;
+    constexpr Endpoint(uchar address, uchar type, uchar interval, uchar maxPacketSize = 8)
+        : bLength(sizeof(Endpoint)), bDescriptorType(USBDESCR_ENDPOINT), bEndpointAddress(address),
+          bmAttributes(type), wMaxPacketSize(maxPacketSize), bInterval(interval) {}
+};
+/* Endpoint descriptor, e.g. Endpoint(IN | 1, INTERRUPT, 10). */
+
+template<unsigned N>
+struct __attribute__((packed)) Bytes{
+    uchar   data[N];
+    static constexpr uchar numInterfaces = 0;
+    static constexpr uchar numEndpoints = 0;
+};
+
+template<typename... T>
+constexpr Bytes<sizeof...(T)> bytes(T... b)
+{
+    return Bytes<sizeof...(T)>{{(uchar)b...}};
+}
+/* Raw bytes, e.g. class specific descriptors like the functional
+ * descriptors of CDC or the audio control descriptors of MIDI. The bytes
+ * include the descriptor's own length field.
+ */
+
+/* ------------------------------------------------------------------------- */
+
+template<unsigned... I> struct Indices{};
+template<unsigned N, unsigned... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...>{};
+template<unsigned... I> struct MakeIndices<0, I...>{ typedef Indices<I...> type; };
+
+template<unsigned N>
+struct __attribute__((packed)) String{
+    int     data[N];
+    template<unsigned... I>
+    constexpr String(const char (&s)[N], Indices<I...>)
+        : data{USB_STRING_DESCRIPTOR_HEADER(N - 1), (uchar)s[I]...} {}
+};
+
+template<unsigned N>
+constexpr String<N> string(const char (&s)[N])
+{
+    return String<N>(s, typename MakeIndices<N - 1>::type());
+}
+/* String descriptor from a string literal. The header replaces the literal's
+ * terminating 0, so the descriptor has the same size as the literal in
+ * 16 bit characters. Characters are Latin-1.
+ */
+
+} /* namespace usbdesc */
+
+#endif /* __USBDESCRIPTORS_HPP_INCLUDED__ */
@@ -0,0 +1,360 @@
+/* Name: usbmidi.c
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+#include <avr/pgmspace.h>
+#include "usbdrv.h"
+#include "usbmidi.h"
+
+#if !USB_CFG_HAVE_INTRIN_ENDPOINT
+#error "usbmidi.c requires USB_CFG_HAVE_INTRIN_ENDPOINT"
+#endif
+#if !USB_CFG_IMPLEMENT_FN_WRITEOUT
+#error "usbmidi.c requires USB_CFG_IMPLEMENT_FN_WRITEOUT"
+#endif
+#if USB_PROP_LENGTH_OF(USB_CFG_DESCR_PROPS_CONFIGURATION) != MIDI_CONFIG_DESCRIPTOR_LENGTH
+#error "USB_CFG_DESCR_PROPS_CONFIGURATION must be USB_PROP_LENGTH(MIDI_CONFIG_DESCRIPTOR_LENGTH)"
+#endif
+
+/* ------------------------------------------------------------------------- */
+/* ----------------------------- Descriptors ------------------------------- */
+/* ------------------------------------------------------------------------- */
+
+/* Length of the class specific MIDI Streaming descriptors, from the MS header
+ * up to the last class specific endpoint descriptor.
+ */
+#define MS_TOTAL_LENGTH (7 + 6 + 6 + 9 + 9 + 9 + 5 + 9 + 5)
+
+PROGMEM const char usbDescriptorConfiguration[MIDI_CONFIG_DESCRIPTOR_LENGTH] = {
+    9,          /* sizeof(usbDescriptorConfiguration): length of descriptor in bytes */
+    USBDESCR_CONFIG,    /* descriptor type */
+    MIDI_CONFIG_DESCRIPTOR_LENGTH, 0,   /* total length of data returned (including inlined descriptors) */
+    2,          /* number of interfaces in this configuration */
+    1,          /* index of this configuration */
+    0,          /* configuration name string index */
+#if USB_CFG_IS_SELF_POWERED
+    (1 << 7) | USBATTR_SELFPOWER,       /* attributes */
+#else
+    (1 << 7),                           /* attributes */
+#endif
+    USB_CFG_MAX_BUS_POWER/2,            /* max USB current in 2mA units */
+/* audio control interface: */
+    9,          /* sizeof(usbDescrInterface): length of descriptor in bytes */
+    USBDESCR_INTERFACE, /* descriptor type */
+    0,          /* index of this interface */
+    0,          /* alternate setting for this interface */
+    0,          /* endpoints excl 0: number of endpoint descriptors to follow */
+    1,          /* interface class: audio */
+    1,          /* interface subclass: audio control */
+    0,          /* interface protocol */
+    0,          /* string index for interface */
+/* class specific audio control header: */
+    9,          /* sizeof(AC header descriptor) */
+    0x24,       /* descriptor type: CS_INTERFACE */
+    1,          /* descriptor subtype: header */
+    0x00, 0x01, /* audio device class specification release 1.00 */
+    9, 0,       /* total length of class specific AC descriptors */
+    1,          /* number of streaming interfaces */
+    1,          /* MIDI streaming interface belongs to this AC interface */
+/* MIDI streaming interface: */
+    9,          /* sizeof(usbDescrInterface): length of descriptor in bytes */
+    USBDESCR_INTERFACE, /* descriptor type */
+    1,          /* index of this interface */
+    0,          /* alternate setting for this interface */
+    2,          /* endpoints excl 0: number of endpoint descriptors to follow */
+    1,          /* interface class: audio */
+    3,          /* interface subclass: MIDI streaming */
+    0,          /* interface protocol */
+    0,          /* string index for interface */
+/* class specific MIDI streaming header: */
+    7,          /* sizeof(MS header descriptor) */
+    0x24,       /* descriptor type: CS_INTERFACE */
+    1,          /* descriptor subtype: MS header */
+    0x00, 0x01, /* MIDI streaming specification release 1.00 */
+    MS_TOTAL_LENGTH, 0, /* total length of class specific MS descriptors */
+/* MIDI IN jack, embedded (data from host): */
+    6,          /* sizeof(MIDI IN jack descriptor) */
+    0x24,       /* descriptor type: CS_INTERFACE */
+    2,          /* descriptor subtype: MIDI IN jack */
+    1,          /* jack type: embedded */
+    1,          /* jack ID */
+    0,          /* string index for jack */
+/* MIDI IN jack, external (data to host): */
+    6,          /* sizeof(MIDI IN jack descriptor) */
+    0x24,       /* descriptor type: CS_INTERFACE */
+    2,          /* descriptor subtype: MIDI IN jack */
+    2,          /* jack type: external */
+    2,          /* jack ID */
+    0,          /* string index for jack */
+/* MIDI OUT jack, embedded (data to host): */
+    9,          /* sizeof(MIDI OUT jack descriptor) */
+    0x24,       /* descriptor type: CS_INTERFACE */
+    3,          /* descriptor subtype: MIDI OUT jack */
+    1,          /* jack type: embedded */
+    3,          /* jack ID */
+    1,          /* number of input pins */
+    2,          /* ID of the entity connected to this pin: external IN jack */
+    1,          /* output pin of that entity */
+    0,          /* string index for jack */
+/* MIDI OUT jack, external (data from host): */
+    9,          /* sizeof(MIDI OUT jack descriptor) */
+    0x24,       /* descriptor type: CS_INTERFACE */
+    3,          /* descriptor subtype: MIDI OUT jack */
+    2,          /* jack type: external */
+    4,          /* jack ID */
+    1,          /* number of input pins */
+    1,          /* ID of the entity connected to this pin: embedded IN jack */
+    1,          /* output pin of that entity */
+    0,          /* string index for jack */
+/* data OUT endpoint: */
+    9,          /* sizeof(audio endpoint descriptor) */
+    USBDESCR_ENDPOINT,  /* descriptor type = endpoint */
+    0x01,       /* OUT endpoint number 1 */
+    MIDI_ENDPOINT_TYPE, /* attrib: bulk or interrupt endpoint */
+    8, 0,       /* maximum packet size */
+    USB_CFG_INTR_POLL_INTERVAL, /* in ms, ignored for bulk */
+    0,          /* refresh, unused */
+    0,          /* synch address, unused */
+/* class specific MIDI streaming OUT endpoint: */
+    5,          /* sizeof(MS endpoint descriptor) */
+    0x25,       /* descriptor type: CS_ENDPOINT */
+    1,          /* descriptor subtype: MS general */
+    1,          /* number of embedded MIDI IN jacks */
+    1,          /* ID of the embedded MIDI IN jack */
+/* data IN endpoint: */
+    9,          /* sizeof(audio endpoint descriptor) */
+    USBDESCR_ENDPOINT,  /* descriptor type = endpoint */
+    (char)0x81, /* IN endpoint number 1 */
+    MIDI_ENDPOINT_TYPE, /* attrib: bulk or interrupt endpoint */
+    8, 0,       /* maximum packet size */
+    USB_CFG_INTR_POLL_INTERVAL, /* in ms, ignored for bulk */
+    0,          /* refresh, unused */
+    0,          /* synch address, unused */
+/* class specific MIDI streaming IN endpoint: */
+    5,          /* sizeof(MS endpoint descriptor) */
+    0x25,       /* descriptor type: CS_ENDPOINT */
+    1,          /* descriptor subtype: MS general */
+    1,          /* number of embedded MIDI OUT jacks */
+    3,          /* ID of the embedded MIDI OUT jack */
+};
+
+/* ------------------------------------------------------------------------- */
+/* ---------------------------- Transmit Queue ----------------------------- */
+/* ------------------------------------------------------------------------- */
+
+#define QUEUE_MASK  (MIDI_QUEUE_SIZE - 1)
+
+typedef struct midiQueueEntry{
+    uchar   time;
+    uchar   event[4];
+}midiQueueEntry_t;
+
+/* Head and tail are free running 8 bit counters, masked on access. */
+static midiQueueEntry_t queue[MIDI_QUEUE_SIZE];
+static uchar            queueHead, queueTail;
+static uchar            currentTime;    /* time passed to last midiPoll() */
+
+uchar   midiQueueFree(void)
+{
+    return MIDI_QUEUE_SIZE - (uchar)(queueHead - queueTail);
+}
+
+#if MIDI_COALESCE
+/* Try to replace the value of a queued event with the new value scheduled for
+ * 'time'. Returns 1 if an event was found.
+ */
+static uchar    coalesceEvent(uchar time, uchar cin, uchar status, uchar data1, uchar data2)
+{
+uchar               i = queueHead;
+midiQueueEntry_t    *e;
+
+    if(cin == 0xb && data1 >= 64)   /* switch or mode controller */
+        return 0;
+    while(i != queueTail){
+        e = &queue[--i & QUEUE_MASK];
+        if((e->event[0] & 0x0f) < 8 || (e->event[0] & 0x0f) == MIDI_CIN_SINGLE_BYTE)
+            continue;   /* system message, does not affect channel state */
+        if((e->event[1] ^ status) & 0x0f)
+            continue;   /* other channel */
+        if(e->event[1] != status)
+            break;      /* other message on same channel, keep the order */
+        if(cin == 0xa || cin == 0xb){
+            if(e->event[2] != data1)
+                continue;   /* other key or controller */
+        }
+        if(e->time != time){    /* values for the same time always replace each other */
+            if((signed char)(currentTime - e->time) < 0 || (signed char)(currentTime - time) < 0)
+                return 0;   /* one of them is scheduled for later, not stale */
+        }
+        e->event[2] = data1;
+        e->event[3] = data2;
+        return 1;
+    }
+    return 0;
+}
+#endif
+
+static uchar    putEvent(uchar time, uchar header, uchar b1, uchar b2, uchar b3)
+{
+midiQueueEntry_t    *e;
+
+#if MIDI_COALESCE
+    if(header >= 0xa && header <= 0xe && header != 0xc){
+        if(coalesceEvent(time, header, b1, b2, b3))
+            return 1;
+    }
+#endif
+    if((uchar)(queueHead - queueTail) >= MIDI_QUEUE_SIZE)
+        return 0;
+    e = &queue[queueHead & QUEUE_MASK];
+    e->time = time;
+    e->event[0] = header;
+    e->event[1] = b1;
+    e->event[2] = b2;
+    e->event[3] = b3;
+    queueHead++;
+    return 1;
+}
+
+uchar   midiQueueEvent(uchar time, const uchar *event)
+{
+    return putEvent(time, event[0], event[1], event[2], event[3]);
+}
+
+/* Returns the length of the message starting with 'status' in bytes. */
+static uchar    messageLength(uchar status)
+{
+    if(status < 0xf0)
+        return (status & 0xe0) == 0xc0 ? 2 : 3;  /* program change and channel pressure have 1 data byte */
+    if(status == 0xf1 || status == 0xf3)
+        return 2;
+    if(status == 0xf2)
+        return 3;
+    return 1;
+}
+
+uchar   midiSendAt(uchar time, uchar status, uchar data1, uchar data2)
+{
+uchar   len = messageLength(status), cin;
+
+    if(status < 0xf0){
+        cin = status >> 4;
+    }else if(status >= 0xf8){
+        cin = MIDI_CIN_SINGLE_BYTE;
+    }else if(status == 0xf6){
+        cin = MIDI_CIN_SYSEX_END_1;
+    }else if(len == 2){
+        cin = MIDI_CIN_SYSCOMMON_2;
+    }else if(len == 3){
+        cin = MIDI_CIN_SYSCOMMON_3;
+    }else{
+        return 1;   /* undefined or SysEx status, ignore */
+    }
+    if(len < 3)
+        data2 = 0;
+    if(len < 2)
+        data1 = 0;
+    return putEvent(time, cin, status, data1, data2);
+}
+
+uchar   midiSend(uchar status, uchar data1, uchar data2)
+{
+    return midiSendAt(currentTime, status, data1, data2);
+}
+
+/* ------------------------------------------------------------------------- */
+/* ----------------------------- Serial Parser ----------------------------- */
+/* ------------------------------------------------------------------------- */
+
+static uchar    runningStatus;  /* 0 if none, 0xf0 during SysEx */
+static uchar    message[3];
+static uchar    messageIndex;   /* number of bytes in message[] */
+
+uchar   midiParseByte(uchar c)
+{
+uchar   len;
+
+    if(c >= 0xf8)   /* real time messages may appear anywhere */
+        return midiSend(c, 0, 0);
+    if(c == 0xf7){
+        if(runningStatus != 0xf0)
+            return 1;
+        message[messageIndex++] = c;
+        len = messageIndex;     /* 1, 2 or 3 bytes are left: CIN 5, 6 or 7 */
+        while(messageIndex < 3)
+            message[messageIndex++] = 0;
+        runningStatus = 0;
+        messageIndex = 0;
+        return putEvent(currentTime, MIDI_CIN_SYSEX + len, message[0], message[1], message[2]);
+    }
+    if(c & 0x80){   /* status byte */
+        runningStatus = c;
+        message[0] = c;
+        messageIndex = 1;
+        if(c != 0xf0 && messageLength(c) == 1){    /* tune request */
+            runningStatus = 0;
+            messageIndex = 0;
+            return midiSend(c, 0, 0);
+        }
+        return 1;
+    }
+    if(runningStatus == 0)  /* data byte without status, ignore */
+        return 1;
+    if(runningStatus == 0xf0){
+        message[messageIndex++] = c;
+        if(messageIndex < 3)
+            return 1;
+        messageIndex = 0;
+        return putEvent(currentTime, MIDI_CIN_SYSEX, message[0], message[1], message[2]);
+    }
+    if(messageIndex == 0)   /* running status */
+        message[messageIndex++] = runningStatus;
+    message[messageIndex++] = c;
+    if(messageIndex < messageLength(runningStatus))
+        return 1;
+    messageIndex = 0;
+    if(runningStatus >= 0xf0)   /* system common messages cancel running status */
+        runningStatus = 0;
+    return midiSend(message[0], message[1], c);
+}
+
+/* ------------------------------------------------------------------------- */
+/* ----------------------------- USB interface ----------------------------- */
+/* ------------------------------------------------------------------------- */
+
+void    usbFunctionWriteOut(uchar *data, uchar len)
+{
+    while(len >= 4){
+        if((data[0] & 0x0f) != 0)   /* CIN 0 is reserved, used as padding */
+            midiEventReceived(data);
+        data += 4;
+        len -= 4;
+    }
+}
+
+void    midiPoll(uchar now)
+{
+uchar               buffer[8], len = 0, i;
+midiQueueEntry_t    *e;
+
+    currentTime = now;
+    if(!usbInterruptIsReady())
+        return;
+    while(len < 8 && queueTail != queueHead){
+        e = &queue[queueTail & QUEUE_MASK];
+        if((signed char)(now - e->time) < 0)
+            break;  /* not due yet */
+        for(i = 0; i < 4; i++){
+            buffer[len++] = e->event[i];
+        }
+        queueTail++;
+    }
+    if(len > 0)
+        usbSetInterrupt(buffer, len);
+}
+
+/* ------------------------------------------------------------------------- */
@@ -0,0 +1,145 @@
+/* Name: usbmidi.h
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+General Description:
+This module implements a USB-MIDI 1.0 device with one MIDI IN and one MIDI
+OUT port. It provides the configuration descriptor with the Audio Control
+and MIDI Streaming interfaces, converts MIDI messages to 4 byte USB-MIDI
+event packets and sends them in a transmit queue.
+
+Endpoints used:
+    endpoint 1 IN ....... events to host (sent via usbSetInterrupt())
+    endpoint 1 OUT ...... events from host (received via usbFunctionWriteOut())
+The endpoints are declared as bulk endpoints by default, as required by the
+USB-MIDI specification. See the note about bulk endpoints on low speed
+devices in cdcacm.h. Define MIDI_ENDPOINT_TYPE to 3 for interrupt endpoints.
+
+Packing:
+Each low speed packet carries up to 8 bytes, which is exactly two event
+packets. midiPoll() always fills the endpoint with two events if two are
+due, so that the rate of MIDI messages is twice the rate of USB packets.
+
+Timestamps:
+Every event is queued with an 8 bit timestamp in units of your choice (e.g.
+milliseconds) and is sent when midiPoll() is called with a time equal to or
+later than the timestamp. Timestamps are compared modulo 256, so an event
+can't be scheduled more than 127 units ahead. Events are sent in the order
+they are queued: queue them with non-decreasing timestamps.
+
+Coalescing:
+Dense controller sweeps can produce messages faster than the host polls the
+endpoint. If MIDI_COALESCE is enabled, a new value for a continuous
+controller (numbers 0 to 63), polyphonic key pressure, channel pressure or
+pitch bend replaces the value of an event for the same channel and
+controller (or key) which is still waiting in the queue, provided that both
+events are already due or both have the same timestamp. The event keeps its
+position, so the host receives the latest value with the least delay and the
+queue never fills up with stale values. A value scheduled for a later time
+never replaces one which is due, so it is not sent early. The search passes
+over events for other channels, system messages and events with the same
+status for other controllers (or keys), because their relative order does
+not matter. It stops at any other message for the same channel, so the order
+of e.g. notes and controllers is preserved. Switch controllers (sustain
+pedal and above) are never coalesced.
+
+Running status:
+midiParseByte() accepts a serial MIDI byte stream (e.g. from a UART
+connected to a DIN socket) and handles running status, real time messages
+interleaved with other messages and system exclusive messages.
+
+Usage:
+This module implements usbFunctionWriteOut() and provides
+usbDescriptorConfiguration. Your firmware must not define them, but it must
+implement midiEventReceived() (see below) and usbFunctionSetup() (which
+may simply return 0, USB-MIDI has no mandatory class requests). Include
+usbmidi.c in your main.c or compile it as a separate module and set the
+following options in usbconfig.h:
+
+#define USB_CFG_HAVE_INTRIN_ENDPOINT        1
+#define USB_CFG_IMPLEMENT_FN_WRITEOUT       1
+#define USB_CFG_DEVICE_ID                   0xe4, 0x05  // shared PID for MIDI
+#define USB_CFG_DESCR_PROPS_CONFIGURATION   USB_PROP_LENGTH(101)
+
+The length of 101 bytes is MIDI_CONFIG_DESCRIPTOR_LENGTH below. Call
+midiPoll() from the main loop after each usbPoll(). All functions must be
+called from the main loop, not from interrupt handlers.
+*/
+
+#ifndef __USBMIDI_H_INCLUDED__
+#define __USBMIDI_H_INCLUDED__
+
+#ifndef uchar
+#define uchar   unsigned char
+#endif
+
+#ifndef MIDI_QUEUE_SIZE
+#define MIDI_QUEUE_SIZE     16
+#endif
+/* Number of events in the transmit queue. Must be a power of 2 between 2 and
+ * 128. Each event requires 5 bytes of RAM.
+ */
+#ifndef MIDI_COALESCE
+#define MIDI_COALESCE       1
+#endif
+/* Set this to 0 if every value of a controller sweep must be sent. */
+#ifndef MIDI_ENDPOINT_TYPE
+#define MIDI_ENDPOINT_TYPE  2
+#endif
+/* Endpoint type of the MIDI data endpoints: 2 for bulk, 3 for interrupt. */
+
+#define MIDI_CONFIG_DESCRIPTOR_LENGTH   101
+/* Value for USB_PROP_LENGTH() in USB_CFG_DESCR_PROPS_CONFIGURATION. */
+
+/* Code index numbers (low nibble of the first byte of an event packet) */
+#define MIDI_CIN_SYSCOMMON_2    0x2     /* 2 byte system common message */
+#define MIDI_CIN_SYSCOMMON_3    0x3     /* 3 byte system common message */
+#define MIDI_CIN_SYSEX          0x4     /* SysEx starts or continues */
+#define MIDI_CIN_SYSEX_END_1    0x5     /* SysEx ends with 1 byte, or 1 byte system common */
+#define MIDI_CIN_SYSEX_END_2    0x6     /* SysEx ends with 2 bytes */
+#define MIDI_CIN_SYSEX_END_3    0x7     /* SysEx ends with 3 bytes */
+#define MIDI_CIN_SINGLE_BYTE    0xf     /* single byte, used for real time messages */
+/* Channel messages use the high nibble of the status byte as code index. */
+
+void    midiPoll(uchar now);
+/* Call this function from the main loop after each usbPoll(). 'now' is the
+ * current time in the units of your timestamps. If the interrupt endpoint is
+ * ready, the next one or two events due are handed to the driver.
+ */
+uchar   midiSendAt(uchar time, uchar status, uchar data1, uchar data2);
+/* Queue a channel message or a system common or real time message which is
+ * sent when the time given by 'time' has come. Unused data bytes are
+ * ignored. Returns 0 if the queue is full and 1 otherwise. Note that the
+ * event may be coalesced with an earlier event, see above.
+ */
+uchar   midiSend(uchar status, uchar data1, uchar data2);
+/* Same as midiSendAt() for the time most recently passed to midiPoll(),
+ * i.e. the message is sent as soon as possible.
+ */
+uchar   midiQueueEvent(uchar time, const uchar *event);
+/* Queue a USB-MIDI event packet of 4 bytes as it is. Use this function for
+ * messages which can't be sent with midiSendAt(), e.g. system exclusive
+ * messages.
+ */
+uchar   midiParseByte(uchar c);
+/* Feed one byte of a serial MIDI stream into the parser. Complete messages
+ * are queued with midiSend(). Returns 0 if a message was lost because the
+ * queue is full and 1 otherwise.
+ */
+uchar   midiQueueFree(void);
+/* Returns the number of events which can be queued. */
+
+extern void midiEventReceived(uchar *event);
+/* This function must be implemented by your firmware. It is called from
+ * usbPoll() with a pointer to each USB-MIDI event packet of 4 bytes received
+ * from the host. event[0] contains the cable number (always 0) in the high
+ * nibble and the code index number in the low nibble, event[1] to event[3]
+ * contain the MIDI message.
+ */
+
+#endif /* __USBMIDI_H_INCLUDED__ */
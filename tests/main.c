@@ -110,8 +110,16 @@ static PROGMEM const char myDescriptorConfiguration[] = { /* USB configuration d
 #endif
 };
 
+#endif
+
+#if USE_DYNAMIC_DESCRIPTOR || USE_DYNAMIC_STRINGS
 USB_PUBLIC usbMsgLen_t usbFunctionDescriptor(usbRequest_t *rq)
 {
+#if USE_DYNAMIC_STRINGS
+    if(rq->wValue.bytes[1] == USBDESCR_STRING)
+        return 0;   /* no strings, we only check the descriptor table layout */
+#endif
+#if USE_DYNAMIC_DESCRIPTOR
 uchar *p = 0, len = 0;
 
     if(rq->wValue.bytes[1] == USBDESCR_DEVICE){
@@ -123,17 +131,128 @@ uchar *p = 0, len = 0;
     }
     usbMsgPtr = (usbMsgPtr_t)p;
     return len;
+#else
+    return 0;
+#endif
+}
+#endif
+
+#if USE_HID_REPORT
+PROGMEM const char usbHidReportDescriptor[22] = {   /* USB report descriptor */
+    0x06, 0x00, 0xff,              // USAGE_PAGE (Generic Desktop)
+    0x09, 0x01,                    // USAGE (Vendor Usage 1)
+    0xa1, 0x01,                    // COLLECTION (Application)
+    0x15, 0x00,                    //   LOGICAL_MINIMUM (0)
+    0x26, 0xff, 0x00,              //   LOGICAL_MAXIMUM (255)
+    0x75, 0x08,                    //   REPORT_SIZE (8)
+    0x95, 0x01,                    //   REPORT_COUNT (1)
+    0x09, 0x00,                    //   USAGE (Undefined)
+    0xb2, 0x02, 0x01,              //   FEATURE (Data,Var,Abs,Buf)
+    0xc0                           // END_COLLECTION
+};
+#endif
+
+#if USB_CFG_HAVE_REQUEST_TABLE
+
+static uchar    buffer[8];
+
+static usbMsgLen_t  handleRequest(usbRequest_t *rq)
+{
+    return 0;
+}
+
+static uchar    streamRequest(uchar *data, uchar len)
+{
+    return len;
+}
+
+PROGMEM const usbRequestEntry_t usbRequestTable[] = {
+    USB_REQUEST_STREAM(USBRQ_TYPE_VENDOR, 0, streamRequest),
+    USB_REQUEST_HANDLER(USBRQ_TYPE_VENDOR, 1, handleRequest),
+    USB_REQUEST_RAM(USBRQ_TYPE_VENDOR, 2, buffer, sizeof(buffer)),
+};
+PROGMEM const uchar usbRequestTableSize = sizeof(usbRequestTable) / sizeof(usbRequestTable[0]);
+
+#endif
+
+#if USB_CFG_HAVE_MSG_SEGMENTS
+static uchar            header[2];
+static PROGMEM const char payload[8] = "segments";
+static usbMsgSegment_t  segments[] = {
+    USB_MSG_SEGMENT_RAM(header, sizeof(header)),
+    USB_MSG_SEGMENT_ROM(payload, sizeof(payload)),
+    USB_MSG_SEGMENT_END
+};
+#endif
+
+#if USE_COMPRESSED_DESCRIPTOR
+/* usually generated by tools/usbdescgen -z */
+PROGMEM const char usbDescriptorStringVendor[12] = {
+    0x01, 18, 3,            /* literal run of 2 bytes: header */
+    0x47, 'o', 'b', 'd', 'e', 'v', '.', 'a', 't',   /* 8 characters */
+};
+PROGMEM const char usbDescriptorStringDevice[8] = {
+    0x01, 10, 3,            /* literal run of 2 bytes: header */
+    0x43, 'T', 'e', 's', 't',                       /* 4 characters */
+};
+#endif
+
+#if USE_EEPROM_DESCRIPTOR
+/* serial number programmed per unit, e.g. with avrdude */
+EEMEM int usbDescriptorStringSerialNumber[] = {
+    USB_STRING_DESCRIPTOR_HEADER(4),
+    '0', '0', '0', '1'
+};
+#endif
+
+#if USB_CFG_DESCR_CRC_TABLES
+/* usually generated by tools/usbdescgen, CRC of the driver's language descriptor */
+static PROGMEM const uchar string0Crc[2] = {0x09, 0x78};
+PROGMEM const usbDescrCrcEntry_t usbDescrCrcTable[1] = {
+    {usbDescriptorString0, string0Crc, 4},
+};
+PROGMEM const uchar usbDescrCrcTableSize = 1;
+#endif
+
+#if USB_CFG_INTERFACE_COUNT > 1
+USB_PUBLIC usbMsgLen_t  vendorSetup(uchar data[8])
+{
+    return 0;
 }
 #endif
 
+#if USB_CFG_HAVE_REQUEST_TABLE != 1
 USB_PUBLIC usbMsgLen_t  usbFunctionSetup(uchar data[8])
 {
 usbRequest_t    *rq = (void *)data;
 
     if(rq->bRequest == 0)   /* request using usbFunctionRead()/usbFunctionWrite() */
         return 0xff;
+#if USB_CFG_HAVE_MSG_SEGMENTS
+    if(rq->bRequest == 1){  /* request using a segmented reply */
+        usbMsgPtr = (usbMsgPtr_t)segments;
+        usbMsgFlags = USB_FLG_MSGPTR_IS_SEGMENTS;
+        return sizeof(header) + sizeof(payload);
+    }
+#endif
+#if USB_CFG_HAVE_EEPROM_DATA
+    if(rq->bRequest == 2){  /* request reading EEPROM */
+        usbMsgPtr = (usbMsgPtr_t)rq->wIndex.word;
+        usbMsgFlags = USB_FLG_MSGPTR_IS_EEPROM;
+        return rq->wLength.word;
+    }
+#endif
+#if USB_CFG_HAVE_FAR_FLASH_DATA
+    if(rq->bRequest == 3){  /* request reading flash memory in any page */
+        usbMsgPtr = (usbMsgPtr_t)rq->wIndex.word;
+        usbMsgPtrPage = rq->wValue.bytes[0];
+        usbMsgFlags = USB_FLG_MSGPTR_IS_ROM;
+        return rq->wLength.word;
+    }
+#endif
 	return 0;   /* default for not implemented requests: return no data back to host */
 }
+#endif
 
 /* ------------------------------------------------------------------------- */
 
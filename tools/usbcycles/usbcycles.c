@@ -0,0 +1,757 @@
+/* Name: usbcycles.c
+ * Project: V-USB tools, host side
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+General Description:
+This command line tool performs a static cycle analysis of the assembler
+modules of the driver (usbdrvasm*.inc and asmcommon.inc). It follows one
+path through the code, starting at a label, and counts the cycles of each
+instruction for the classic AVR core. It lists the computed cycle next to the
+cycle number given in brackets in the comment and reports where the two
+drift apart. Each "in ..., USBIN" instruction is a sample of the bus. The
+tool reports the distance of each sample from the ideal bit grid of the
+configured clock rate.
+
+This helps when a receiver is modified or written for a new clock rate: all
+sampling instructions and the budgets between packets can be checked
+without a simulator. See Readme.txt for the options.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <limits.h>
+
+#define MAX_LINES       8192
+#define MAX_SYMBOLS     256
+#define MAX_TARGETS     32
+#define MAX_NESTING     16
+#define NO_ANNOTATION   INT_MIN
+
+typedef struct{
+    const char  *file;
+    int         lineNumber;
+    char        label[32];      /* empty if no label on this line */
+    char        mnemonic[16];   /* empty if no instruction on this line */
+    char        operands[64];
+    int         annotation;     /* first [n] in the comment */
+    int         macro;          /* index of macro this line belongs to, -1 if none */
+}line_t;
+
+typedef struct{
+    char    name[32];
+    int     first, last;        /* line range of the body */
+}macro_t;
+
+typedef struct{
+    char    name[64];
+    long    value;
+}symbol_t;
+
+typedef struct{
+    char    label[32];
+    int     count;              /* remaining number of times to take the branch */
+}target_t;
+
+static line_t   lines[MAX_LINES];
+static int      numLines;
+static macro_t  macros[MAX_SYMBOLS];
+static int      numMacros;
+static symbol_t symbols[MAX_SYMBOLS];
+static int      numSymbols;
+static target_t targets[MAX_TARGETS];   /* option -t */
+static int      numTargets;
+static char     *avoid[MAX_TARGETS];    /* option -x */
+static int      numAvoid;
+static int      errorCount;
+
+static int      clockKhz = 12000;       /* option -c */
+static int      maxInstructions = 300;  /* option -n */
+static int      annotationAfter;        /* option -e */
+
+/* ------------------------------------------------------------------------- */
+
+static void usage(char *name)
+{
+    fprintf(stderr, "usage: %s [options] <file> [<file> ...]\n", name);
+    fprintf(stderr, "  Follows one path through AVR assembler code and counts cycles.\n"
+                    "  -c <kHz> ....... CPU clock for the sample analysis (default 12000)\n"
+                    "  -s <label> ..... start label (default USB_INTR_VECTOR)\n"
+                    "  -t <label>[:n] . take conditional branches to label (n times, default 1)\n"
+                    "  -x <label> ..... skip instructions skip jumps to this label\n"
+                    "  -D <sym>[=val] . define preprocessor symbol\n"
+                    "  -n <count> ..... maximum number of instructions (default 300)\n"
+                    "  -e ............. bracketed cycles count after the instruction\n");
+}
+
+static void *allocate(size_t size)
+{
+void    *p = calloc(1, size);
+
+    if(p == NULL){
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+/* ------------------------------------------------------------------------- */
+/* ------------------------ preprocessor conditionals ---------------------- */
+/* ------------------------------------------------------------------------- */
+
+static symbol_t *findSymbol(const char *name)
+{
+int     i;
+
+    for(i = 0; i < numSymbols; i++){
+        if(strcmp(symbols[i].name, name) == 0)
+            return &symbols[i];
+    }
+    return NULL;
+}
+
+static void defineSymbol(const char *name, long value)
+{
+symbol_t    *s = findSymbol(name);
+
+    if(s == NULL){
+        if(numSymbols >= MAX_SYMBOLS){
+            fprintf(stderr, "too many symbols\n");
+            exit(1);
+        }
+        s = &symbols[numSymbols++];
+        snprintf(s->name, sizeof(s->name), "%s", name);
+    }
+    s->value = value;
+}
+
+/* Minimal expression evaluator for #if: numbers, symbols, defined(), !, ==,
+ * !=, &&, || and parentheses. Undefined symbols evaluate to 0 as in cpp.
+ */
+static const char   *exprPtr;
+
+static long evalOr(void);
+
+static void skipSpace(void)
+{
+    while(isspace((unsigned char)*exprPtr))
+        exprPtr++;
+}
+
+static long evalPrimary(void)
+{
+long    value = 0;
+char    name[64];
+int     i, hasParen;
+
+    skipSpace();
+    if(*exprPtr == '!'){
+        exprPtr++;
+        return !evalPrimary();
+    }
+    if(*exprPtr == '('){
+        exprPtr++;
+        value = evalOr();
+        skipSpace();
+        if(*exprPtr == ')')
+            exprPtr++;
+        return value;
+    }
+    if(isdigit((unsigned char)*exprPtr)){
+        value = strtol(exprPtr, (char **)&exprPtr, 0);
+        while(isalpha((unsigned char)*exprPtr))    /* suffixes like UL */
+            exprPtr++;
+        return value;
+    }
+    for(i = 0; (isalnum((unsigned char)*exprPtr) || *exprPtr == '_') && i < (int)sizeof(name) - 1; i++)
+        name[i] = *exprPtr++;
+    name[i] = 0;
+    if(i == 0){     /* unknown operator, give up on this expression */
+        exprPtr += strlen(exprPtr);
+        return 0;
+    }
+    if(strcmp(name, "defined") == 0){
+        skipSpace();
+        hasParen = *exprPtr == '(';
+        if(hasParen)
+            exprPtr++;
+        skipSpace();
+        for(i = 0; (isalnum((unsigned char)*exprPtr) || *exprPtr == '_') && i < (int)sizeof(name) - 1; i++)
+            name[i] = *exprPtr++;
+        name[i] = 0;
+        skipSpace();
+        if(hasParen && *exprPtr == ')')
+            exprPtr++;
+        return findSymbol(name) != NULL;
+    }
+    return findSymbol(name) != NULL ? findSymbol(name)->value : 0;
+}
+
+static long evalCompare(void)
+{
+long    value = evalPrimary();
+
+    for(;;){
+        skipSpace();
+        if(exprPtr[0] == '=' && exprPtr[1] == '='){
+            exprPtr += 2;
+            value = value == evalPrimary();
+        }else if(exprPtr[0] == '!' && exprPtr[1] == '='){
+            exprPtr += 2;
+            value = value != evalPrimary();
+        }else{
+            return value;
+        }
+    }
+}
+
+static long evalAnd(void)
+{
+long    value = evalCompare();
+
+    for(;;){
+        skipSpace();
+        if(exprPtr[0] != '&' || exprPtr[1] != '&')
+            return value;
+        exprPtr += 2;
+        value = evalCompare() && value;
+    }
+}
+
+static long evalOr(void)
+{
+long    value = evalAnd();
+
+    for(;;){
+        skipSpace();
+        if(exprPtr[0] != '|' || exprPtr[1] != '|')
+            return value;
+        exprPtr += 2;
+        value = evalAnd() || value;
+    }
+}
+
+static long evaluate(const char *expression)
+{
+    exprPtr = expression;
+    return evalOr();
+}
+
+/* ------------------------------------------------------------------------- */
+/* -------------------------------- parser --------------------------------- */
+/* ------------------------------------------------------------------------- */
+
+static void parseFile(const char *fileName, int depth);
+
+/* Removes comments from the line and returns the first [n] annotation found
+ * in a ';' or '//' comment.
+ */
+static int  stripComments(char *line, int *inComment)
+{
+int     annotation = NO_ANNOTATION;
+char    *p, *q, *end;
+
+    for(p = line; *p != 0; ){
+        if(*inComment){
+            q = strstr(p, "*/");
+            if(q == NULL){
+                *p = 0;
+                break;
+            }
+            memmove(p, q + 2, strlen(q + 2) + 1);
+            *inComment = 0;
+        }else if(p[0] == '/' && p[1] == '*'){
+            *inComment = 1;
+            memmove(p, p + 2, strlen(p + 2) + 1);
+        }else if(*p == ';' || (p[0] == '/' && p[1] == '/')){
+            for(q = p; (q = strchr(q, '[')) != NULL; q++){
+                long    n = strtol(q + 1, &end, 10);
+                if(end != q + 1 && *end == ']'){
+                    annotation = n;
+                    break;
+                }
+            }
+            *p = 0;
+            break;
+        }else{
+            p++;
+        }
+    }
+    return annotation;
+}
+
+/* Handles a preprocessor line. The stack holds for each nesting level whether
+ * the current branch is active and whether a branch was already active.
+ */
+static int  ifActive[MAX_NESTING], ifDone[MAX_NESTING], ifDepth;
+
+static int  isActive(void)
+{
+int     i;
+
+    for(i = 0; i < ifDepth; i++){
+        if(!ifActive[i])
+            return 0;
+    }
+    return 1;
+}
+
+static void preprocessor(char *p, const char *fileName, int lineNumber, int depth)
+{
+char    directive[16], name[64], *path, *q;
+int     i, value;
+
+    p++;
+    while(isspace((unsigned char)*p))
+        p++;
+    for(i = 0; isalpha((unsigned char)*p) && i < (int)sizeof(directive) - 1; i++)
+        directive[i] = *p++;
+    directive[i] = 0;
+    while(isspace((unsigned char)*p))
+        p++;
+    if(strcmp(directive, "if") == 0 || strcmp(directive, "ifdef") == 0 || strcmp(directive, "ifndef") == 0){
+        if(ifDepth >= MAX_NESTING){
+            fprintf(stderr, "%s:%d: conditionals nested too deeply\n", fileName, lineNumber);
+            exit(1);
+        }
+        if(directive[2] == 0){
+            value = evaluate(p) != 0;
+        }else{
+            sscanf(p, "%63s", name);
+            value = (findSymbol(name) != NULL) == (directive[2] == 'd');
+        }
+        ifActive[ifDepth] = value;
+        ifDone[ifDepth++] = value;
+    }else if(strcmp(directive, "elif") == 0 && ifDepth > 0){
+        value = !ifDone[ifDepth - 1] && evaluate(p) != 0;
+        ifActive[ifDepth - 1] = value;
+        ifDone[ifDepth - 1] |= value;
+    }else if(strcmp(directive, "else") == 0 && ifDepth > 0){
+        ifActive[ifDepth - 1] = !ifDone[ifDepth - 1];
+        ifDone[ifDepth - 1] = 1;
+    }else if(strcmp(directive, "endif") == 0 && ifDepth > 0){
+        ifDepth--;
+    }else if(!isActive()){
+        return;
+    }else if(strcmp(directive, "define") == 0){
+        if(sscanf(p, "%63s", name) == 1){
+            p += strlen(name);
+            defineSymbol(name, evaluate(p));
+        }
+    }else if(strcmp(directive, "include") == 0 && *p == '"'){
+        /* include files relative to the including file, ignore system headers */
+        q = strchr(p + 1, '"');
+        if(q == NULL)
+            return;
+        *q = 0;
+        path = allocate(strlen(fileName) + strlen(p));
+        strcpy(path, fileName);
+        q = strrchr(path, '/');
+        strcpy(q == NULL ? path : q + 1, p + 1);
+        parseFile(path, depth + 1);
+    }
+}
+
+static int  findMacro(const char *name)
+{
+int     i;
+
+    for(i = 0; i < numMacros; i++){
+        if(strcasecmp(macros[i].name, name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static void parseFile(const char *fileName, int depth)
+{
+FILE    *fp;
+char    buffer[512], *p, *q;
+int     lineNumber = 0, inComment = 0, annotation, currentMacro = -1;
+int     i, baseDepth = ifDepth;
+line_t  *l;
+
+    if(depth > 4){
+        fprintf(stderr, "%s: includes nested too deeply\n", fileName);
+        exit(1);
+    }
+    if((fp = fopen(fileName, "r")) == NULL){
+        perror(fileName);
+        errorCount++;
+        return;
+    }
+    while(fgets(buffer, sizeof(buffer), fp) != NULL){
+        lineNumber++;
+        p = buffer;
+        while(isspace((unsigned char)*p))
+            p++;
+        if(!inComment && *p == '#'){
+            preprocessor(p, fileName, lineNumber, depth);
+            continue;
+        }
+        annotation = stripComments(buffer, &inComment);
+        if(!isActive())
+            continue;
+        if(numLines >= MAX_LINES){
+            fprintf(stderr, "%s: too many lines\n", fileName);
+            exit(1);
+        }
+        l = &lines[numLines];
+        memset(l, 0, sizeof(*l));
+        l->file = fileName;
+        l->lineNumber = lineNumber;
+        l->annotation = annotation;
+        l->macro = currentMacro;
+        p = buffer;
+        while(isspace((unsigned char)*p))
+            p++;
+        /* label? */
+        for(q = p; isalnum((unsigned char)*q) || *q == '_'; q++)
+            ;
+        if(*q == ':' && q > p){
+            *q = 0;
+            snprintf(l->label, sizeof(l->label), "%.31s", p);
+            p = q + 1;
+            while(isspace((unsigned char)*p))
+                p++;
+        }
+        for(i = 0; *p != 0 && !isspace((unsigned char)*p) && i < (int)sizeof(l->mnemonic) - 1; i++)
+            l->mnemonic[i] = tolower((unsigned char)*p++);
+        l->mnemonic[i] = 0;
+        while(isspace((unsigned char)*p))
+            p++;
+        snprintf(l->operands, sizeof(l->operands), "%.63s", p);
+        for(i = strlen(l->operands); i > 0 && isspace((unsigned char)l->operands[i - 1]); i--)
+            l->operands[i - 1] = 0;
+        if(strcmp(l->mnemonic, "macro") == 0 || strcmp(l->mnemonic, ".macro") == 0){
+            if(numMacros >= MAX_SYMBOLS){
+                fprintf(stderr, "too many macros\n");
+                exit(1);
+            }
+            currentMacro = numMacros++;
+            sscanf(l->operands, "%31[A-Za-z0-9_]", macros[currentMacro].name);
+            macros[currentMacro].first = numLines + 1;
+            l->macro = currentMacro;
+            l->mnemonic[0] = 0;
+        }else if(strcmp(l->mnemonic, "endm") == 0 || strcmp(l->mnemonic, ".endm") == 0
+                || strcmp(l->mnemonic, ".endmacro") == 0){
+            if(currentMacro >= 0)
+                macros[currentMacro].last = numLines;
+            currentMacro = -1;
+            l->mnemonic[0] = 0;
+        }else if(l->mnemonic[0] == '.'){
+            l->mnemonic[0] = 0; /* assembler directive */
+        }
+        if(l->label[0] != 0 || l->mnemonic[0] != 0 || l->macro >= 0)
+            numLines++;
+    }
+    fclose(fp);
+    if(ifDepth != baseDepth){
+        fprintf(stderr, "%s: unterminated conditional\n", fileName);
+        ifDepth = baseDepth;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/* ------------------------------- analysis -------------------------------- */
+/* ------------------------------------------------------------------------- */
+
+static int  findLabel(const char *label)
+{
+int     i;
+
+    for(i = 0; i < numLines; i++){
+        if(lines[i].macro < 0 && strcmp(lines[i].label, label) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static int  isOneOf(const char *mnemonic, const char *list)
+{
+char    buffer[256], *p;
+
+    snprintf(buffer, sizeof(buffer), "%s", list);
+    for(p = strtok(buffer, " "); p != NULL; p = strtok(NULL, " ")){
+        if(strcmp(p, mnemonic) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* Cycles of the classic AVR core (devices with up to 128 kB flash) when no
+ * branch is taken and no instruction is skipped.
+ */
+static int  baseCycles(const char *mnemonic)
+{
+symbol_t    *fixedRegisters;
+
+    if(isOneOf(mnemonic, "save_sreg restore_sreg")){    /* macros from usbdrvasm.S */
+        fixedRegisters = findSymbol("USB_CFG_FIXED_REGISTERS");
+        if(fixedRegisters == NULL || !fixedRegisters->value)
+            return 3;
+        return mnemonic[0] == 's' ? 2 : 1;    /* SAVE_SREG also clears YL */
+    }
+    if(isOneOf(mnemonic, "push pop ld st ldd std lds sts adiw sbiw rjmp ijmp sbi cbi mul muls mulsu fmul nop2"))
+        return 2;
+    if(isOneOf(mnemonic, "jmp rcall icall lpm elpm"))
+        return 3;
+    if(isOneOf(mnemonic, "call ret reti"))
+        return 4;
+    if(isOneOf(mnemonic, "add adc sub subi sbc sbci and andi or ori eor com neg inc dec tst clr ser "
+                         "mov movw ldi in out cp cpc cpi lsl lsr rol ror asr swap bst bld sbr cbr "
+                         "sec clc sen cln sez clz sei cli ses cls sev clv set clt seh clh nop "
+                         "bset bclr cpse sbrc sbrs sbic sbis"))
+        return 1;
+    if(mnemonic[0] == 'b' && mnemonic[1] == 'r')
+        return 1;
+    return -1;
+}
+
+static int  isWordCount2(const char *mnemonic)
+{
+    return isOneOf(mnemonic, "lds sts jmp call");
+}
+
+static target_t *findTarget(const char *label)
+{
+int     i;
+
+    for(i = 0; i < numTargets; i++){
+        if(strcmp(targets[i].label, label) == 0)
+            return &targets[i];
+    }
+    return NULL;
+}
+
+static int  isAvoided(const char *label)
+{
+int     i;
+
+    for(i = 0; i < numAvoid; i++){
+        if(strcmp(avoid[i], label) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* returns the index of the next line with an instruction in the same scope */
+static int  nextInstruction(int i)
+{
+int     macro = lines[i].macro;
+
+    for(i++; i < numLines && lines[i].macro == macro; i++){
+        if(lines[i].mnemonic[0] != 0)
+            return i;
+    }
+    return -1;
+}
+
+static void analyze(const char *startLabel)
+{
+int     pc, returnStack[MAX_NESTING], macroStack[MAX_NESTING], sp = 0;
+int     cycle = 0, cycles, steps = 0, next, i;
+int     annotationOffset = NO_ANNOTATION, drift = 0;
+int     samples[256], numSamples = 0;
+double  bitTime = clockKhz / 1500.0, deviation, maxDeviation = 0;
+char    mark, *operand;
+line_t  *l;
+target_t *t;
+
+    if((pc = findLabel(startLabel)) < 0){
+        fprintf(stderr, "label \"%s\" not found\n", startLabel);
+        exit(1);
+    }
+    printf(" cycle  +n  [ann]    instruction\n");
+    while(steps < maxInstructions){
+        if(pc < 0 || pc >= numLines){
+            printf("end of code reached\n");
+            break;
+        }
+        l = &lines[pc];
+        if(sp > 0 && pc >= macros[macroStack[sp - 1]].last){  /* end of macro expansion */
+            pc = returnStack[--sp];
+            continue;
+        }
+        if(sp == 0 && l->macro >= 0){   /* skip macro definitions */
+            pc++;
+            continue;
+        }
+        if(l->label[0] != 0 && steps > 0 && pc == findLabel(startLabel)){
+            printf("%6d  back at %s: loop of %d cycles\n", cycle, startLabel, cycle);
+            break;
+        }
+        if(l->label[0] != 0)
+            printf("%s:\n", l->label);
+        if(l->mnemonic[0] == 0){
+            pc++;
+            continue;
+        }
+        if((i = findMacro(l->mnemonic)) >= 0){
+            if(sp >= MAX_NESTING){
+                fprintf(stderr, "macros nested too deeply\n");
+                exit(1);
+            }
+            printf("              %s %s\n", l->mnemonic, l->operands);
+            macroStack[sp] = i;
+            returnStack[sp++] = pc + 1;
+            pc = macros[i].first;
+            continue;
+        }
+        steps++;
+        cycles = baseCycles(l->mnemonic);
+        if(cycles < 0){
+            fprintf(stderr, "%s:%d: unknown instruction \"%s\", counted as 1 cycle\n", l->file, l->lineNumber, l->mnemonic);
+            cycles = 1;
+        }
+        next = pc + 1;
+        operand = strrchr(l->operands, ',');
+        operand = operand == NULL ? l->operands : operand + 1;
+        while(isspace((unsigned char)*operand))
+            operand++;
+        if(isOneOf(l->mnemonic, "rjmp jmp") && strncmp(operand, ".+0", 3) != 0 && strncmp(operand, "$+2", 3) != 0){
+            next = findLabel(operand);
+            if(next < 0){
+                fprintf(stderr, "%s:%d: jump target \"%s\" not found\n", l->file, l->lineNumber, operand);
+                errorCount++;
+            }
+        }else if(l->mnemonic[0] == 'b' && l->mnemonic[1] == 'r'
+                && (strcmp(operand, startLabel) == 0 || ((t = findTarget(operand)) != NULL && t->count-- > 0))){
+            cycles++;   /* branches back to the start label close the loop */
+            next = findLabel(operand);
+        }else if(isOneOf(l->mnemonic, "cpse sbrc sbrs sbic sbis")){
+            i = nextInstruction(pc);
+            if(i >= 0 && isAvoided(lines[i].operands)){
+                cycles += isWordCount2(lines[i].mnemonic) ? 2 : 1;
+                next = nextInstruction(i);
+            }
+        }else if(isOneOf(l->mnemonic, "rcall call icall")){
+            fprintf(stderr, "%s:%d: subroutine call not followed\n", l->file, l->lineNumber);
+        }
+        mark = ' ';
+        if(l->annotation != NO_ANNOTATION){
+            int ref = annotationAfter ? cycle + cycles : cycle;
+            if(annotationOffset == NO_ANNOTATION)
+                annotationOffset = l->annotation - ref;
+            if(l->annotation - ref != annotationOffset){
+                mark = '!';
+                drift++;
+                annotationOffset = l->annotation - ref;
+            }
+        }
+        if(l->annotation != NO_ANNOTATION)
+            printf("%6d  %2d  [%3d]%c   %-6s %-24s", cycle, cycles, l->annotation, mark, l->mnemonic, l->operands);
+        else
+            printf("%6d  %2d           %-6s %-24s", cycle, cycles, l->mnemonic, l->operands);
+        if(strcmp(l->mnemonic, "in") == 0 && strstr(l->operands, "USBIN") != NULL && numSamples < 256){
+            samples[numSamples++] = cycle;
+            printf(" <-- sample %d", numSamples - 1);
+        }
+        printf("\n");
+        cycle += cycles;
+        if(isOneOf(l->mnemonic, "ret reti ijmp")){
+            printf("%6d  return\n", cycle);
+            break;
+        }
+        pc = next;
+    }
+    printf("\n%d instructions, %d cycles\n", steps, cycle);
+    if(drift > 0)
+        printf("%d lines where bracketed cycles drift from the computed ones (marked '!')\n", drift);
+    if(numSamples > 0){
+        printf("\nsamples of USBIN, bit time %.3f cycles at %d kHz:\n", bitTime, clockKhz);
+        for(i = 0; i < numSamples; i++){
+            int     bit = (int)((samples[i] - samples[0]) / bitTime + 0.5);
+            deviation = samples[i] - samples[0] - bit * bitTime;
+            if(deviation > maxDeviation || -deviation > maxDeviation)
+                maxDeviation = deviation < 0 ? -deviation : deviation;
+            printf("  sample %2d at cycle %5d: bit %3d, %+.2f cycles from grid%s\n", i, samples[i],
+                   bit, deviation, i > 0 && (samples[i] - samples[i - 1]) / bitTime < 0.5 ? " (re-sample)" : "");
+        }
+        printf("maximum deviation %.2f cycles (%.0f%% of a bit)\n", maxDeviation, 100 * maxDeviation / bitTime);
+        if(maxDeviation > bitTime / 4){
+            printf("WARNING: samples are more than 1/4 bit off the grid\n");
+            errorCount++;
+        }
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+const char  *startLabel = "USB_INTR_VECTOR";
+char        *p, *arg;
+int         i, option;
+
+    for(i = 1; i < argc && argv[i][0] == '-'; i++){
+        option = argv[i][1];
+        if(option == 'e' && argv[i][2] == 0){
+            annotationAfter = 1;
+            continue;
+        }
+        if(option == 'D' && argv[i][2] != 0){   /* -DSYMBOL as with cc */
+            arg = argv[i] + 2;
+        }else{
+            if(option == 0 || argv[i][2] != 0 || i + 1 >= argc){
+                usage(argv[0]);
+                exit(1);
+            }
+            arg = argv[++i];
+        }
+        switch(option){
+        case 'c':
+            clockKhz = atoi(arg);
+            break;
+        case 's':
+            startLabel = arg;
+            break;
+        case 'n':
+            maxInstructions = atoi(arg);
+            break;
+        case 't':
+            if(numTargets >= MAX_TARGETS)
+                break;
+            snprintf(targets[numTargets].label, sizeof(targets[0].label), "%s", arg);
+            targets[numTargets].count = 1;
+            if((p = strchr(targets[numTargets].label, ':')) != NULL){
+                *p = 0;
+                targets[numTargets].count = atoi(p + 1);
+            }
+            numTargets++;
+            break;
+        case 'x':
+            if(numAvoid < MAX_TARGETS)
+                avoid[numAvoid++] = arg;
+            break;
+        case 'D':
+            p = strchr(arg, '=');
+            if(p != NULL)
+                *p++ = 0;
+            defineSymbol(arg, p == NULL ? 1 : strtol(p, NULL, 0));
+            break;
+        default:
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+    if(i >= argc || clockKhz <= 0){
+        usage(argv[0]);
+        exit(1);
+    }
+    defineSymbol("USB_CFG_CLOCK_KHZ", clockKhz);
+    for(; i < argc; i++)
+        parseFile(argv[i], 0);
+    if(errorCount > 0)
+        exit(1);
+    analyze(startLabel);
+    return errorCount > 0 ? 1 : 0;
+}
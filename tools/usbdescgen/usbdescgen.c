@@ -0,0 +1,736 @@
+/* Name: usbdescgen.c
+ * Project: V-USB tools, host side
+ * Author: V-USB contributors
+ * Creation Date: 2026-10-18
+ * Tabsize: 4
+ * Copyright: (c) 2026 by OBJECTIVE DEVELOPMENT Software GmbH
+ * License: GNU GPL v2 (see License.txt), GNU GPL v3 or proprietary (CommercialLicense.txt)
+ */
+
+/*
+General Description:
+This command line tool reads a description of a USB device (see Readme.txt
+for the syntax) and generates the device's descriptors for V-USB:
+
+<prefix>.h ... usbconfig.h fragment with the USB_CFG_DESCR_PROPS_* defines
+               and all other options which depend on the descriptors (IDs,
+               names, endpoints, HID report descriptor length etc.). Include
+               it at the end of usbconfig.h.
+<prefix>.c ... descriptors as PROGMEM arrays and a table with the CRC of
+               each 8 byte packet of each descriptor. Include it in main.c
+               or compile it as separate module.
+
+All lengths and counts in the descriptors are computed by the tool, so they
+can't get out of sync with the data.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+
+#define MAX_TOKENS          64
+#define MAX_INTERFACES      8
+#define MAX_ENDPOINTS       4   /* per interface */
+#define MAX_STRINGS         10  /* string indices supported by the driver */
+#define MAX_DESCRIPTOR      1024
+
+typedef struct{
+    int     address;    /* including direction bit */
+    int     type;       /* 2 = bulk, 3 = interrupt */
+    int     maxPacket;
+    int     interval;
+}endpoint_t;
+
+typedef struct{
+    int             bClass, subClass, protocol;
+    int             nameIndex;
+    unsigned char   classDescriptor[MAX_DESCRIPTOR];    /* inserted after interface descriptor */
+    int             classDescriptorLen;
+    unsigned char   hidReport[MAX_DESCRIPTOR];
+    int             hidReportLen;   /* -1 if not HID */
+    endpoint_t      endpoints[MAX_ENDPOINTS];
+    int             numEndpoints;
+}interface_t;
+
+typedef struct{
+    const char      *name;          /* C identifier */
+    const char      *propsName;     /* USB_CFG_DESCR_PROPS_* */
+    const char      *type;          /* C type of the array elements */
+    unsigned char   data[MAX_DESCRIPTOR];
+    int             len;
+    unsigned char   packed[MAX_DESCRIPTOR + MAX_DESCRIPTOR / 64 + 1];
+    int             packedLen;      /* 0 if not compressed */
+}descriptor_t;
+
+static const char   *inputFile;
+static int          lineNumber;
+static int          errorCount;
+static int          compress;       /* option -z */
+
+static int          vendorId = -1, productId = -1, deviceVersion = 0x0100;
+static int          deviceClass, deviceSubClass, deviceProtocol;
+static int          maxPower = 100, selfPowered, remoteWakeup;
+static int          configurationNameIndex;
+static char         *strings[MAX_STRINGS];  /* index 1 = vendor, 2 = product, 3 = serial */
+static int          numStrings = 4;         /* extra strings start at index 4 */
+static interface_t  interfaces[MAX_INTERFACES];
+static int          numInterfaces;
+
+/* ------------------------------------------------------------------------- */
+
+static void usage(char *name)
+{
+    fprintf(stderr, "usage: %s [-z] <description-file> <output-prefix>\n", name);
+    fprintf(stderr, "  Generates <output-prefix>.h (usbconfig.h fragment) and\n"
+                    "  <output-prefix>.c (descriptors and CRC tables).\n"
+                    "  -z ... compress descriptors (see USB_PROP_IS_COMPRESSED)\n");
+}
+
+static void error(const char *format, ...)
+{
+va_list vlist;
+
+    va_start(vlist, format);
+    fprintf(stderr, "%s:%d: ", inputFile, lineNumber);
+    vfprintf(stderr, format, vlist);
+    fprintf(stderr, "\n");
+    va_end(vlist);
+    errorCount++;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Split a line into tokens. Commas separate tokens like white space, so that
+ * byte lists can be copied from C source. Comments start with '#' or '//'.
+ * Strings are enclosed in double quotes and returned with the leading quote.
+ */
+static int  tokenize(char *line, char **tokens)
+{
+int     n = 0;
+char    *p = line;
+
+    for(;;){
+        while(isspace((unsigned char)*p) || *p == ',')
+            p++;
+        if(*p == 0 || *p == '#' || (p[0] == '/' && p[1] == '/'))
+            break;
+        if(n >= MAX_TOKENS){
+            error("too many tokens");
+            break;
+        }
+        tokens[n++] = p;
+        if(*p == '"'){
+            p++;
+            while(*p != 0 && *p != '"')
+                p++;
+            if(*p == 0){
+                error("unterminated string");
+                break;
+            }
+            *p++ = 0;   /* token is '"' followed by the string */
+        }else{
+            while(*p != 0 && !isspace((unsigned char)*p) && *p != ',')
+                p++;
+            if(*p != 0)
+                *p++ = 0;
+        }
+    }
+    return n;
+}
+
+static int  number(char *token, int min, int max)
+{
+long    l;
+char    *end;
+
+    l = strtol(token, &end, 0);
+    if(end == token || *end != 0){
+        error("invalid number \"%s\"", token);
+        return min;
+    }
+    if(l < min || l > max){
+        error("value %s out of range %d...%d", token, min, max);
+        return min;
+    }
+    return l;
+}
+
+static char *string(char *token)
+{
+    if(token[0] != '"'){
+        error("string in double quotes expected");
+        return "";
+    }
+    return token + 1;
+}
+
+static int  addString(char *token)
+{
+    if(numStrings >= MAX_STRINGS){
+        error("too many strings, the driver supports %d", MAX_STRINGS - 4);
+        return 0;
+    }
+    strings[numStrings] = strdup(string(token));
+    return numStrings++;
+}
+
+static interface_t  *currentInterface(const char *keyword)
+{
+    if(numInterfaces == 0){
+        error("\"%s\" must follow \"interface\"", keyword);
+        return NULL;
+    }
+    return &interfaces[numInterfaces - 1];
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void parse(FILE *fp)
+{
+char        line[1024], *tokens[MAX_TOKENS];
+int         n;
+interface_t *iface;
+int         blockLen = 0, *blockLenPtr = NULL;
+unsigned char *block = NULL;
+
+    while(fgets(line, sizeof(line), fp) != NULL){
+        lineNumber++;
+        n = tokenize(line, tokens);
+        if(n == 0)
+            continue;
+        if(block != NULL){  /* inside of byte list */
+            int i;
+            if(strcmp(tokens[0], "end") == 0){
+                *blockLenPtr = blockLen;
+                block = NULL;
+                continue;
+            }
+            for(i = 0; i < n; i++){
+                if(blockLen >= MAX_DESCRIPTOR){
+                    error("byte list too long");
+                    break;
+                }
+                block[blockLen++] = number(tokens[i], -128, 255);
+            }
+            continue;
+        }
+        if(strcmp(tokens[0], "device") == 0 && (n == 3 || n == 4)){
+            vendorId = number(tokens[1], 0, 0xffff);
+            productId = number(tokens[2], 0, 0xffff);
+            if(n == 4)
+                deviceVersion = number(tokens[3], 0, 0xffff);
+        }else if(strcmp(tokens[0], "class") == 0 && n == 4){
+            deviceClass = number(tokens[1], 0, 255);
+            deviceSubClass = number(tokens[2], 0, 255);
+            deviceProtocol = number(tokens[3], 0, 255);
+        }else if(strcmp(tokens[0], "vendor") == 0 && n == 2){
+            strings[1] = strdup(string(tokens[1]));
+        }else if(strcmp(tokens[0], "product") == 0 && n == 2){
+            strings[2] = strdup(string(tokens[1]));
+        }else if(strcmp(tokens[0], "serial") == 0 && n == 2){
+            strings[3] = strdup(string(tokens[1]));
+        }else if(strcmp(tokens[0], "power") == 0 && n >= 2){
+            int i;
+            maxPower = number(tokens[1], 0, 500);
+            for(i = 2; i < n; i++){
+                if(strcmp(tokens[i], "self-powered") == 0){
+                    selfPowered = 1;
+                }else if(strcmp(tokens[i], "remote-wakeup") == 0){
+                    remoteWakeup = 1;
+                }else{
+                    error("unknown power attribute \"%s\"", tokens[i]);
+                }
+            }
+        }else if(strcmp(tokens[0], "configuration") == 0 && n == 2){
+            configurationNameIndex = addString(tokens[1]);
+        }else if(strcmp(tokens[0], "interface") == 0 && (n == 4 || n == 5)){
+            if(numInterfaces >= MAX_INTERFACES){
+                error("too many interfaces");
+                continue;
+            }
+            iface = &interfaces[numInterfaces++];
+            iface->bClass = number(tokens[1], 0, 255);
+            iface->subClass = number(tokens[2], 0, 255);
+            iface->protocol = number(tokens[3], 0, 255);
+            iface->hidReportLen = -1;
+            if(n == 5)
+                iface->nameIndex = addString(tokens[4]);
+        }else if(strcmp(tokens[0], "hid-report") == 0 && n == 1){
+            if((iface = currentInterface(tokens[0])) == NULL)
+                continue;
+            block = iface->hidReport;
+            blockLenPtr = &iface->hidReportLen;
+            blockLen = 0;
+        }else if(strcmp(tokens[0], "class-descriptor") == 0 && n == 1){
+            if((iface = currentInterface(tokens[0])) == NULL)
+                continue;
+            block = iface->classDescriptor;
+            blockLenPtr = &iface->classDescriptorLen;
+            blockLen = iface->classDescriptorLen;   /* append to previous */
+        }else if(strcmp(tokens[0], "endpoint") == 0 && (n == 5 || n == 6)){
+            endpoint_t  *ep;
+            if((iface = currentInterface(tokens[0])) == NULL)
+                continue;
+            if(iface->numEndpoints >= MAX_ENDPOINTS){
+                error("too many endpoints");
+                continue;
+            }
+            ep = &iface->endpoints[iface->numEndpoints++];
+            ep->address = number(tokens[2], 1, 15);
+            if(strcmp(tokens[1], "in") == 0){
+                ep->address |= 0x80;
+            }else if(strcmp(tokens[1], "out") != 0){
+                error("endpoint direction must be \"in\" or \"out\"");
+            }
+            if(strcmp(tokens[3], "interrupt") == 0){
+                ep->type = 3;
+            }else if(strcmp(tokens[3], "bulk") == 0){
+                ep->type = 2;
+            }else{
+                error("endpoint type must be \"interrupt\" or \"bulk\"");
+            }
+            ep->interval = number(tokens[4], 0, 255);
+            ep->maxPacket = n == 6 ? number(tokens[5], 1, 8) : 8;
+        }else{
+            error("syntax error at \"%s\"", tokens[0]);
+        }
+    }
+    if(block != NULL)
+        error("missing \"end\"");
+    if(vendorId < 0)
+        error("missing \"device\"");
+    if(numInterfaces == 0)
+        error("missing \"interface\"");
+}
+
+/* ------------------------------------------------------------------------- */
+
+static descriptor_t descriptors[4 + 3];
+static int          numDescriptors;
+
+static descriptor_t *newDescriptor(const char *name, const char *propsName, const char *type)
+{
+descriptor_t    *d = &descriptors[numDescriptors++];
+
+    d->name = name;
+    d->propsName = propsName;
+    d->type = type;
+    d->len = 0;
+    return d;
+}
+
+static void append(descriptor_t *d, int byte)
+{
+    if(d->len >= MAX_DESCRIPTOR){
+        error("descriptor %s too long", d->name);
+        return;
+    }
+    d->data[d->len++] = byte;
+}
+
+static void appendWord(descriptor_t *d, int word)
+{
+    append(d, word & 0xff);
+    append(d, (word >> 8) & 0xff);
+}
+
+static void buildStringDescriptor(descriptor_t *d, const char *s)
+{
+    append(d, 2 + 2 * strlen(s));
+    append(d, 3);   /* descriptor type string */
+    while(*s)
+        appendWord(d, (unsigned char)*s++); /* Latin-1 to UTF-16 */
+}
+
+static void buildDescriptors(void)
+{
+descriptor_t    *d;
+int             i, j, totalLenOffset;
+
+    d = newDescriptor("usbDescriptorDevice", "DEVICE", "char");
+    append(d, 18);
+    append(d, 1);           /* descriptor type device */
+    appendWord(d, 0x0110);  /* USB version 1.1 */
+    append(d, deviceClass);
+    append(d, deviceSubClass);
+    append(d, deviceProtocol);
+    append(d, 8);           /* max packet size of endpoint 0 */
+    appendWord(d, vendorId);
+    appendWord(d, productId);
+    appendWord(d, deviceVersion);
+    append(d, strings[1] != NULL ? 1 : 0);
+    append(d, strings[2] != NULL ? 2 : 0);
+    append(d, strings[3] != NULL ? 3 : 0);
+    append(d, 1);           /* number of configurations */
+
+    d = newDescriptor("usbDescriptorConfiguration", "CONFIGURATION", "char");
+    append(d, 9);
+    append(d, 2);           /* descriptor type configuration */
+    totalLenOffset = d->len;
+    appendWord(d, 0);       /* total length, filled in below */
+    append(d, numInterfaces);
+    append(d, 1);           /* configuration value */
+    append(d, configurationNameIndex);
+    append(d, 0x80 | (selfPowered ? 0x40 : 0) | (remoteWakeup ? 0x20 : 0));
+    append(d, maxPower / 2);
+    for(i = 0; i < numInterfaces; i++){
+        interface_t *iface = &interfaces[i];
+        append(d, 9);
+        append(d, 4);       /* descriptor type interface */
+        append(d, i);
+        append(d, 0);       /* alternate setting */
+        append(d, iface->numEndpoints);
+        append(d, iface->bClass);
+        append(d, iface->subClass);
+        append(d, iface->protocol);
+        append(d, iface->nameIndex);
+        if(iface->hidReportLen >= 0){
+            append(d, 9);
+            append(d, 0x21);        /* descriptor type HID */
+            appendWord(d, 0x0101);  /* HID version */
+            append(d, 0);           /* country code */
+            append(d, 1);           /* number of class descriptors */
+            append(d, 0x22);        /* descriptor type report */
+            appendWord(d, iface->hidReportLen);
+        }
+        for(j = 0; j < iface->classDescriptorLen; j++)
+            append(d, iface->classDescriptor[j]);
+        for(j = 0; j < iface->numEndpoints; j++){
+            endpoint_t  *ep = &iface->endpoints[j];
+            append(d, 7);
+            append(d, 5);   /* descriptor type endpoint */
+            append(d, ep->address);
+            append(d, ep->type);
+            appendWord(d, ep->maxPacket);
+            append(d, ep->interval);
+        }
+    }
+    d->data[totalLenOffset] = d->len & 0xff;
+    d->data[totalLenOffset + 1] = d->len >> 8;
+
+    for(i = 0; i < numInterfaces; i++){
+        if(interfaces[i].hidReportLen >= 0){
+            d = newDescriptor("usbDescriptorHidReport", "HID_REPORT", "char");
+            for(j = 0; j < interfaces[i].hidReportLen; j++)
+                append(d, interfaces[i].hidReport[j]);
+            break;
+        }
+    }
+
+    d = newDescriptor("usbDescriptorString0", "STRING_0", "char");
+    append(d, 4);
+    append(d, 3);           /* descriptor type string */
+    appendWord(d, 0x0409);  /* US-English */
+    if(strings[1] != NULL)
+        buildStringDescriptor(newDescriptor("usbDescriptorStringVendor", "STRING_VENDOR", "int"), strings[1]);
+    if(strings[2] != NULL)
+        buildStringDescriptor(newDescriptor("usbDescriptorStringDevice", "STRING_PRODUCT", "int"), strings[2]);
+    if(strings[3] != NULL)
+        buildStringDescriptor(newDescriptor("usbDescriptorStringSerialNumber", "STRING_SERIAL_NUMBER", "int"), strings[3]);
+}
+
+/* Check the restrictions of the driver. */
+static void checkDevice(void)
+{
+int i, j, numIn = 0, numHid = 0;
+
+    lineNumber = 0;
+    for(i = 0; i < numInterfaces; i++){
+        if(interfaces[i].hidReportLen >= 0){
+            if(numHid++ > 0)
+                error("the driver supports only one HID report descriptor");
+            else if(i != 0)
+                fprintf(stderr, "%s: warning: HID descriptor requests are only answered for interface 0\n", inputFile);
+        }
+        for(j = 0; j < interfaces[i].numEndpoints; j++){
+            endpoint_t  *ep = &interfaces[i].endpoints[j];
+            if(ep->address & 0x80){
+                if(numIn == 0 && ep->address != 0x81)
+                    error("the first IN endpoint must be endpoint 1");
+                if(++numIn > 2)
+                    error("the driver supports at most 2 IN endpoints");
+            }
+        }
+    }
+    for(i = 0; i < numDescriptors; i++){
+        if(descriptors[i].len > 0x0fff)
+            error("descriptor %s is longer than USB_PROP_LENGTH() allows", descriptors[i].name);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Compress a descriptor in the format unpacked by usbUnpackRead() in
+ * usbdrv.c. Copies may only refer to bytes of plain literal runs because the
+ * driver reads them from flash memory, not from the unpacked data. Each step
+ * greedily takes the token which saves the most bytes.
+ */
+static void compressDescriptor(descriptor_t *d)
+{
+unsigned char   *out = d->packed;
+char            isLiteral[sizeof(d->packed)];
+int             n = 0, run = -1, pos = 0;
+
+    while(pos < d->len){
+        int i, j, copyLen = 0, copySource = 0, wideLen = 0;
+        for(i = n - 256; i < n; i++){   /* longest copy from literal bytes */
+            if(i < 0 || !isLiteral[i])
+                continue;
+            for(j = 0; j < 130 && pos + j < d->len && i + j < n && isLiteral[i + j]; j++){
+                if(out[i + j] != d->data[pos + j])
+                    break;
+            }
+            if(j > copyLen){
+                copyLen = j;
+                copySource = i;
+            }
+        }
+        while(wideLen < 64 && pos + 2 * wideLen + 1 < d->len && d->data[pos + 2 * wideLen + 1] == 0)
+            wideLen++;
+        if(copyLen >= 3 && copyLen - 2 >= wideLen - 1){
+            out[n] = 0x80 | (copyLen - 3);
+            out[n + 1] = n - 1 - copySource;
+            isLiteral[n] = isLiteral[n + 1] = 0;
+            n += 2;
+            pos += copyLen;
+            run = -1;
+        }else if(wideLen >= 2){
+            out[n] = 0x40 | (wideLen - 1);
+            isLiteral[n++] = 0;
+            for(i = 0; i < wideLen; i++){
+                out[n] = d->data[pos + 2 * i];
+                isLiteral[n++] = 0;
+            }
+            pos += 2 * wideLen;
+            run = -1;
+        }else{
+            if(run < 0 || out[run] == 0x3f){    /* start new literal run */
+                run = n;
+                out[n] = 0xff;  /* incremented to 0 below */
+                isLiteral[n++] = 0;
+            }
+            out[run]++;
+            out[n] = d->data[pos++];
+            isLiteral[n++] = 1;
+        }
+    }
+    d->packedLen = n;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Binary complement of the USB data CRC, as computed by usbCrc16(). */
+static unsigned crc16(const unsigned char *data, int len)
+{
+unsigned    crc = 0xffff;
+int         i;
+
+    while(len-- > 0){
+        crc ^= *data++;
+        for(i = 0; i < 8; i++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xa001 : crc >> 1;
+    }
+    return crc ^ 0xffff;
+}
+
+static void writeConfigString(FILE *fp, const char *name, const char *s)
+{
+    fprintf(fp, "#undef  %s\n#undef  %s_LEN\n", name, name);
+    if(s == NULL || *s == 0){
+        fprintf(fp, "#define %s_LEN 0\n", name);
+        return;
+    }
+    fprintf(fp, "#define %s_LEN %d\n", name, (int)strlen(s));
+    fprintf(fp, "#define %s ", name);
+    for(; *s; s++)
+        fprintf(fp, *s == '\'' || *s == '\\' ? "'\\%c'%s" : "'%c'%s", *s, s[1] ? ", " : "\n");
+}
+
+static void writeHeader(FILE *fp)
+{
+int         i, j, numIn = 0, haveOut = 0, pollInterval = 10, ep3Number = 3;
+interface_t *iface = &interfaces[0];
+const char  *props[] = {"DEVICE", "CONFIGURATION", "STRINGS", "STRING_0", "STRING_VENDOR", "STRING_PRODUCT",
+                        "STRING_SERIAL_NUMBER", "HID", "HID_REPORT", "UNKNOWN"};
+
+    for(i = 0; i < numInterfaces; i++){
+        for(j = 0; j < interfaces[i].numEndpoints; j++){
+            endpoint_t  *ep = &interfaces[i].endpoints[j];
+            if(ep->address & 0x80){
+                if(numIn++ == 0){
+                    pollInterval = ep->interval;
+                }else{
+                    ep3Number = ep->address & 0x0f;
+                }
+            }else{
+                haveOut = 1;
+            }
+        }
+    }
+    fprintf(fp, "/* Generated by usbdescgen from %s -- do not edit!\n", inputFile);
+    fprintf(fp, " * Include this file at the end of usbconfig.h.\n */\n\n");
+    fprintf(fp, "#undef  USB_CFG_VENDOR_ID\n#define USB_CFG_VENDOR_ID       0x%02x, 0x%02x\n", vendorId & 0xff, vendorId >> 8);
+    fprintf(fp, "#undef  USB_CFG_DEVICE_ID\n#define USB_CFG_DEVICE_ID       0x%02x, 0x%02x\n", productId & 0xff, productId >> 8);
+    fprintf(fp, "#undef  USB_CFG_DEVICE_VERSION\n#define USB_CFG_DEVICE_VERSION  0x%02x, 0x%02x\n", deviceVersion & 0xff, deviceVersion >> 8);
+    writeConfigString(fp, "USB_CFG_VENDOR_NAME", strings[1]);
+    writeConfigString(fp, "USB_CFG_DEVICE_NAME", strings[2]);
+    writeConfigString(fp, "USB_CFG_SERIAL_NUMBER", strings[3]);
+    fprintf(fp, "#undef  USB_CFG_DEVICE_CLASS\n#define USB_CFG_DEVICE_CLASS        %d\n", deviceClass);
+    fprintf(fp, "#undef  USB_CFG_DEVICE_SUBCLASS\n#define USB_CFG_DEVICE_SUBCLASS     %d\n", deviceSubClass);
+    fprintf(fp, "#undef  USB_CFG_INTERFACE_CLASS\n#define USB_CFG_INTERFACE_CLASS     %d\n", iface->bClass);
+    fprintf(fp, "#undef  USB_CFG_INTERFACE_SUBCLASS\n#define USB_CFG_INTERFACE_SUBCLASS  %d\n", iface->subClass);
+    fprintf(fp, "#undef  USB_CFG_INTERFACE_PROTOCOL\n#define USB_CFG_INTERFACE_PROTOCOL  %d\n", iface->protocol);
+    fprintf(fp, "#undef  USB_CFG_IS_SELF_POWERED\n#define USB_CFG_IS_SELF_POWERED     %d\n", selfPowered);
+    fprintf(fp, "#undef  USB_CFG_MAX_BUS_POWER\n#define USB_CFG_MAX_BUS_POWER       %d\n", maxPower);
+    fprintf(fp, "#undef  USB_CFG_HAVE_INTRIN_ENDPOINT\n#define USB_CFG_HAVE_INTRIN_ENDPOINT    %d\n", numIn > 0);
+    fprintf(fp, "#undef  USB_CFG_HAVE_INTRIN_ENDPOINT3\n#define USB_CFG_HAVE_INTRIN_ENDPOINT3   %d\n", numIn > 1);
+    fprintf(fp, "#undef  USB_CFG_EP3_NUMBER\n#define USB_CFG_EP3_NUMBER              %d\n", ep3Number);
+    fprintf(fp, "#undef  USB_CFG_INTR_POLL_INTERVAL\n#define USB_CFG_INTR_POLL_INTERVAL      %d\n", pollInterval);
+    fprintf(fp, "#undef  USB_CFG_IMPLEMENT_FN_WRITEOUT\n#define USB_CFG_IMPLEMENT_FN_WRITEOUT   %d\n", haveOut);
+    fprintf(fp, "#undef  USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH\n");
+    for(i = 0; i < numDescriptors; i++){
+        if(strcmp(descriptors[i].propsName, "HID_REPORT") == 0)
+            fprintf(fp, "#define USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH    %d\n", descriptors[i].len);
+    }
+    if(numStrings > 4){
+        fprintf(fp, "#undef  USB_CFG_STRING_COUNT\n#define USB_CFG_STRING_COUNT    %d\n", numStrings);
+        for(i = 4; i < numStrings; i++){
+            char    name[32];
+            sprintf(name, "USB_CFG_STRING_%d", i);
+            writeConfigString(fp, name, strings[i]);
+        }
+    }
+    fprintf(fp, "\n");
+    for(i = 0; i < (int)(sizeof(props) / sizeof(props[0])); i++){
+        int len = 0, packed = 0;
+        for(j = 0; j < numDescriptors; j++){
+            if(strcmp(descriptors[j].propsName, props[i]) == 0){
+                len = descriptors[j].len;
+                packed = descriptors[j].packedLen != 0;
+            }
+        }
+        if(strcmp(props[i], "HID") == 0 && iface->hidReportLen >= 0)
+            len = 9;    /* the driver finds it at offset 18 of the configuration */
+        fprintf(fp, "#undef  USB_CFG_DESCR_PROPS_%s\n", props[i]);
+        if(packed){
+            fprintf(fp, "#define USB_CFG_DESCR_PROPS_%-22s (USB_PROP_IS_COMPRESSED | USB_PROP_LENGTH(%d))\n", props[i], len);
+        }else if(len){
+            fprintf(fp, "#define USB_CFG_DESCR_PROPS_%-22s USB_PROP_LENGTH(%d)\n", props[i], len);
+        }else{
+            fprintf(fp, "#define USB_CFG_DESCR_PROPS_%-22s 0\n", props[i]);
+        }
+    }
+    fprintf(fp, "\n#undef  USB_CFG_DESCR_CRC_TABLES\n#define USB_CFG_DESCR_CRC_TABLES    1\n");
+}
+
+static void writeSource(FILE *fp)
+{
+int i, j, numCrcTables = 0;
+
+    fprintf(fp, "/* Generated by usbdescgen from %s -- do not edit!\n", inputFile);
+    fprintf(fp, " * Include this file in main.c or compile it as separate module.\n */\n\n");
+    fprintf(fp, "#include <avr/pgmspace.h>\n#include \"usbdrv.h\"\n");
+    for(i = 0; i < numDescriptors; i++){
+        descriptor_t    *d = &descriptors[i];
+        int             isInt = strcmp(d->type, "int") == 0;
+        if(d->packedLen != 0){
+            fprintf(fp, "\n/* compressed, %d bytes unpacked */", d->len);
+            fprintf(fp, "\nPROGMEM const char %s[%d] = {", d->name, d->packedLen);
+            for(j = 0; j < d->packedLen; j++)
+                fprintf(fp, "%s0x%02x,", j % 16 == 0 ? "\n    " : " ", d->packed[j]);
+            fprintf(fp, "\n};\n");
+            continue;
+        }
+        fprintf(fp, "\nPROGMEM const %s %s[%d] = {", d->type, d->name, isInt ? d->len / 2 : d->len);
+        for(j = 0; j < d->len; j += isInt ? 2 : 1){
+            fprintf(fp, "%s", j % 16 == 0 ? "\n    " : " ");
+            if(isInt){
+                fprintf(fp, "0x%04x,", d->data[j] | (d->data[j + 1] << 8));
+            }else{
+                fprintf(fp, "0x%02x,", d->data[j]);
+            }
+        }
+        fprintf(fp, "\n};\n");
+    }
+    fprintf(fp, "\n/* CRC of each packet of 8 bytes (or less for the last packet), low byte first */\n");
+    for(i = 0; i < numDescriptors; i++){
+        descriptor_t    *d = &descriptors[i];
+        if(d->len > 255 || d->packedLen != 0)    /* the driver counts bytes with 8 bit */
+            continue;
+        numCrcTables++;
+        fprintf(fp, "static PROGMEM const uchar %sCrc[%d] = {\n   ", d->name, 2 * ((d->len + 7) / 8));
+        for(j = 0; j < d->len; j += 8){
+            unsigned crc = crc16(d->data + j, d->len - j < 8 ? d->len - j : 8);
+            fprintf(fp, " 0x%02x, 0x%02x,", crc & 0xff, crc >> 8);
+        }
+        fprintf(fp, "\n};\n");
+    }
+    fprintf(fp, "\nPROGMEM const usbDescrCrcEntry_t usbDescrCrcTable[%d] = {\n", numCrcTables);
+    for(i = 0; i < numDescriptors; i++){
+        descriptor_t    *d = &descriptors[i];
+        if(d->len <= 255 && d->packedLen == 0)
+            fprintf(fp, "    {%s, %sCrc, %d},\n", d->name, d->name, d->len);
+    }
+    fprintf(fp, "};\nPROGMEM const uchar usbDescrCrcTableSize = %d;\n", numCrcTables);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+FILE    *fp;
+char    *name;
+int     i;
+
+    if(argc == 4 && strcmp(argv[1], "-z") == 0){
+        compress = 1;
+        argv++;
+        argc--;
+    }
+    if(argc != 3){
+        usage(argv[0]);
+        exit(1);
+    }
+    inputFile = argv[1];
+    if((fp = fopen(inputFile, "r")) == NULL){
+        perror(inputFile);
+        exit(1);
+    }
+    parse(fp);
+    fclose(fp);
+    buildDescriptors();
+    checkDevice();
+    if(errorCount > 0)
+        exit(1);
+    for(i = 0; compress && i < numDescriptors; i++){
+        descriptor_t    *d = &descriptors[i];
+        /* The driver sends the HID descriptor from within the configuration
+         * and looks up extra strings by their bLength.
+         */
+        if(strcmp(d->propsName, "CONFIGURATION") == 0 && interfaces[0].hidReportLen >= 0)
+            continue;
+        if(strncmp(d->propsName, "STRING", 6) == 0 && numStrings > 4)
+            continue;
+        compressDescriptor(d);
+        if(d->packedLen >= d->len)
+            d->packedLen = 0;
+    }
+    name = malloc(strlen(argv[2]) + 3);
+    sprintf(name, "%s.h", argv[2]);
+    if((fp = fopen(name, "w")) == NULL){
+        perror(name);
+        exit(1);
+    }
+    writeHeader(fp);
+    fclose(fp);
+    sprintf(name, "%s.c", argv[2]);
+    if((fp = fopen(name, "w")) == NULL){
+        perror(name);
+        exit(1);
+    }
+    writeSource(fp);
+    fclose(fp);
+    return 0;
+}
@@ -60,6 +60,20 @@ section at the end of this file).
 
 /* ----------------------- Optional Hardware Config ------------------------ */
 
+/* #define USB_CFG_CLOCK2_KHZ          16000 */
+/* #define USB_CFG_CLOCK3_KHZ          20000 */
+/* Define these to link receivers for a second (and third) clock rate in
+ * addition to the one for USB_CFG_CLOCK_KHZ, so that one firmware image runs
+ * on boards with different crystals or RC oscillator settings. You must
+ * assemble usbdrvasm2.S (and usbdrvasm3.S) in addition to usbdrvasm.S. The
+ * interrupt uses the receiver selected by usbClockIndex, which you set at
+ * startup, e.g. with usbSelectClock() (see usbdrv.h). The dispatch adds 5
+ * to 10 cycles to the interrupt latency (see usbdrvasm.S for each receiver)
+ * and reduces the time the application may disable interrupts by the same
+ * amount, e.g. to 15 cycles for a 12 MHz receiver in the worst case. F_CPU is
+ * still used by the C code, e.g. for delays. This option can't be combined
+ * with USB_CFG_CHECK_CRC.
+ */
 /* #define USB_CFG_PULLUP_IOPORTNAME   D */
 /* If you connect the 1.5k pullup resistor from D- to a port pin instead of
  * V+, you can connect and disconnect the device from firmware by calling
@@ -109,6 +123,19 @@ section at the end of this file).
  * (e.g. HID), but never want to send any data. This option saves a couple
  * of bytes in flash memory and the transmit buffers in RAM.
  */
+#define USB_CFG_SHARED_TX_BUFFER        0
+/* Define this to 1 if endpoint 0 and the interrupt-in endpoints should send
+ * from one shared transmit buffer instead of one buffer per endpoint. This
+ * saves 7 bytes of RAM with endpoint 1 and 17 bytes with endpoints 1 and 3,
+ * but only one endpoint can have a packet pending at a time. Control-in data
+ * waits until interrupt data has been collected by the host, which never
+ * happens if the host doesn't poll the interrupt endpoint, e.g. because the
+ * device is not configured. The driver therefore drops pending interrupt
+ * data when a control transfer needs the buffer for its reply and on bus
+ * reset, and reports this in usbIntrDropped (see usbdrv.h).
+ * usbInterruptIsReady() returns false while the device is not configured or
+ * control-in data is pending. Useful on devices with 128 or 256 bytes of RAM.
+ */
 #define USB_CFG_INTR_POLL_INTERVAL      10
 /* If you compile a version with endpoint 1 (interrupt-in), this is the poll
  * interval. The value is in milliseconds and must not be less than 10 ms for
@@ -150,11 +177,58 @@ section at the end of this file).
  * where the driver's constants (descriptors) are located. Or in other words:
  * Define this to 1 for boot loaders on the ATMega128.
  */
+#define USB_CFG_HAVE_FAR_FLASH_DATA     0
+/* Define this to 1 if usbFunctionSetup() may return flash memory data
+ * outside of USB_CFG_DRIVER_FLASH_PAGE, e.g. tables or firmware images
+ * above 64 kB on the ATMega2560. The page is passed in usbMsgPtrPage, see
+ * usbdrv.h. Flash memory replies are then read with ELPM and may cross 64 kB
+ * boundaries.
+ */
 #define USB_CFG_LONG_TRANSFERS          0
 /* Define this to 1 if you want to send/receive blocks of more than 254 bytes
  * in a single control-in or control-out transfer. Note that the capability
  * for long transfers increases the driver size.
  */
+#define USB_CFG_USE_DISPATCH_TABLE      0
+/* This option selects how the driver dispatches standard requests (in
+ * usbDriverSetup()) and GET_DESCRIPTOR requests (in usbDriverDescriptor()).
+ * If set to 1, both are dispatched through tables in flash memory: the
+ * request number indexes a table of handler functions and the descriptor type
+ * (plus string index) indexes a table of descriptor pointers and properties.
+ * The default (0) is a chain of if() comparisons, or a switch statement if
+ * USB_CFG_USE_SWITCH_STATEMENT is defined to 1. The chain compares the
+ * request with each case in turn, so that its cost depends on the position of
+ * the request in the chain (GET_DESCRIPTOR is the fifth case) and on the
+ * number of descriptors. The tables cost a bounds check, two flash reads and
+ * an indirect call regardless of the request, which shortens the time from
+ * SETUP to the first reply packet for requests late in the chain. The tables
+ * may increase code size. Run "make sizes" in the tests directory to compare
+ * the variants with your compiler.
+ */
+#define USB_CFG_HAVE_REQUEST_TABLE      0
+/* Set this to 1 if class and vendor requests should be dispatched through a
+ * table in flash memory instead of usbFunctionSetup(). The table maps
+ * bmRequestType and bRequest to a handler function, a buffer in RAM or flash
+ * memory or a stream function for the data phase and is searched with a
+ * binary search. See usbRequestEntry_t in usbdrv.h for how to define the
+ * table. If set to 2, requests not found in the table are passed to
+ * usbFunctionSetup() as usual, which allows to move the most frequent
+ * requests to the table without rewriting the rest.
+ */
+#define USB_CFG_HAVE_MSG_SEGMENTS       0
+/* Set this to 1 if replies to control-in transfers may consist of several
+ * segments in RAM and flash memory. usbFunctionSetup() then passes a list of
+ * segments in usbMsgPtr, see usbMsgSegment_t in usbdrv.h. This avoids
+ * copying e.g. a RAM status header and a table in flash memory into one RAM
+ * buffer. The option adds a RAM flag check to every data packet.
+ */
+#define USB_CFG_HAVE_EEPROM_DATA        0
+/* Set this to 1 if usbFunctionSetup() or usbFunctionDescriptor() may return
+ * data in EEPROM by setting usbMsgFlags to USB_FLG_MSGPTR_IS_EEPROM. The
+ * driver then reads the data from EEPROM while it is sent and no
+ * usbFunctionRead() is needed. This option is enabled automatically if a
+ * descriptor has the property USB_PROP_IS_EEPROM.
+ */
 /* #define USB_RX_USER_HOOK(data, len)     if(usbRxToken == (uchar)USBPID_SETUP) blinkLED(); */
 /* This macro is a hook if you want to do unconventional things. If it is
  * defined, it's inserted at the beginning of received message processing.
@@ -201,7 +275,48 @@ section at the end of this file).
  * errors, when the host does not receive an ACK. Please note that you need to
  * implement the filtering yourself in usbFunctionWriteOut() and
  * usbFunctionWrite(). Use the global usbCurrentDataToken and a static variable
- * for each control- and out-endpoint to check for duplicate packets.
+ * for each control- and out-endpoint to check for duplicate packets. See
+ * USB_CFG_FILTER_DATA_TOGGLING below for filtering in the driver.
+ */
+#define USB_CFG_FILTER_DATA_TOGGLING    0
+/* define this macro to 1 if the driver should filter out duplicate data
+ * packets itself. The interrupt routine stores the data PID with each packet
+ * (2 cycles, as with USB_CFG_CHECK_DATA_TOGGLING) and usbPoll() drops a
+ * packet with the same PID as the last one accepted on its control- or
+ * out-endpoint. usbFunctionWrite() and usbFunctionWriteOut() then never see
+ * duplicates. This costs 17 bytes of RAM with USB_CFG_IMPLEMENT_FN_WRITEOUT,
+ * 2 bytes otherwise.
+ */
+#define USB_CFG_FAST_IDLE_EXIT      0
+/* define this macro to 1 if you want the interrupt to return directly from
+ * the receiver when it finds no sync pattern, e.g. for the 1 ms low speed
+ * keep-alive. This saves 2 cycles per interrupt at the cost of 6 to 8 bytes
+ * of flash memory. See "CPU LOAD ON AN IDLE BUS" in Readme.txt for figures.
+ */
+#define USB_CFG_STALL_ON_CRC_ERROR  0
+/* Define this to 1 if usbPoll() should check the CRC of control transfers
+ * at all clock rates. The interrupt has already acknowledged the packet at
+ * this point, so the host does not retry it. Instead, a corrupted SETUP or
+ * control-out data packet aborts the transfer: usbFunctionSetup() or
+ * usbFunctionWrite() is not called for the rest of the transfer and the
+ * status stage is answered with STALL. The host reports the error instead
+ * of a success and can repeat the request. Packets for endpoints other than
+ * 0 are passed on unchecked since dropping them would lose them silently.
+ * The check costs ca. 250 cycles per packet with USB_USE_FAST_CRC, otherwise
+ * ca. 500. Ignored with USB_CFG_CHECK_CRC, which checks the CRC in the
+ * interrupt.
+ */
+#define USB_CFG_FIXED_REGISTERS 0
+/* Define this to 1 if you compile all of your firmware with
+ * -ffixed-r2 -ffixed-r3 -ffixed-r4 -ffixed-r5 -ffixed-r6 -ffixed-r7.
+ * The interrupt routine then saves SREG in r2 instead of on the stack and
+ * the driver keeps its state shared with the interrupt (usbRxLen, usbTxLen,
+ * usbCurrentTok, usbInputBufOffset and usbDeviceAddr) in r3 to r7. This saves
+ * 3 cycles on every interrupt and a few more per packet, and makes usbPoll()
+ * smaller. Precompiled library code which uses these registers (e.g.
+ * printf() from avr-libc) must not be called. Not available with IAR and on
+ * XMEGA, AVRxt and reduced tiny cores, which don't map the registers into
+ * the data address space.
  */
 #define USB_CFG_HAVE_MEASURE_FRAME_LENGTH   0
 /* define this macro to 1 if you want the function usbMeasureFrameLength()
@@ -266,6 +381,34 @@ section at the end of this file).
  * to fine tune control over USB descriptors such as the string descriptor
  * for the serial number.
  */
+/*#define USB_CFG_STRING_COUNT    6 */
+/*#define USB_CFG_STRING_4        'S', 'e', 't', 'u', 'p' */
+/*#define USB_CFG_STRING_4_LEN    5 */
+/*#define USB_CFG_STRING_5        'C', 'o', 'n', 't', 'r', 'o', 'l' */
+/*#define USB_CFG_STRING_5_LEN    7 */
+/* If USB_CFG_STRING_COUNT is defined, the driver serves string descriptors
+ * 0 to USB_CFG_STRING_COUNT - 1 from a table in flash memory which is indexed
+ * by the string index. Strings 1 to 3 are the vendor name, device name and
+ * serial number above, strings 4 to 9 are defined with USB_CFG_STRING_4 to
+ * USB_CFG_STRING_9 in the same way. Other string indices are handled as
+ * unknown descriptors. All string descriptors must be in flash memory, not
+ * in RAM or dynamic.
+ */
+/*#define USB_CFG_CONFIGURATION_STRING    4 */
+/*#define USB_CFG_INTERFACE_STRING        5 */
+/* String indices of the configuration and interface name in the default
+ * configuration descriptor. 0 (the default) means no string.
+ */
+/*#define USB_CFG_LANGUAGE_IDS    0x09, 0x04, 0x07, 0x04 */
+/*#define USB_CFG_LANGUAGE_COUNT  2 */
+/* Language IDs reported in string descriptor 0, low byte first (0x0409 is
+ * US-English, 0x0407 is German). The strings above belong to the first
+ * language. If you define more than one language, you must provide the
+ * strings of the others in a table
+ * PROGMEM const int *const usbStringTableLanguages[USB_CFG_LANGUAGE_COUNT - 1][USB_CFG_STRING_COUNT];
+ * with pointers to string descriptors in flash memory (see the note about
+ * string descriptors below). NULL entries fall back to the first language.
+ */
 #define USB_CFG_DEVICE_CLASS        0xff    /* set to 0 if deferred to interface */
 #define USB_CFG_DEVICE_SUBCLASS     0
 /* See USB specification if you want to conform to an existing device class.
@@ -286,6 +429,30 @@ section at the end of this file).
  * "usbHidReportDescriptor" to your code which contains the report descriptor.
  * Don't forget to keep the array and this define in sync!
  */
+/* #define USB_CFG_INTERFACE_COUNT     2 */
+/* Define this to 2 or 3 for a composite device with several interfaces, e.g.
+ * a keyboard and a mouse. Interface 0 is described by the settings above and
+ * has endpoint 1. Interfaces 1 and 2 are described by the settings below:
+ *   USB_CFG_IFACEn_CLASS, _SUBCLASS and _PROTOCOL as above.
+ *   USB_CFG_IFACEn_ENDPOINT: 3 if the interface has endpoint 3 (requires
+ *     USB_CFG_HAVE_INTRIN_ENDPOINT3), 0 if it has no interrupt endpoint.
+ *   USB_CFG_IFACEn_HID_REPORT_LENGTH: length of the HID report descriptor
+ *     if the interface is a HID. It must be stored in a PROGMEM character
+ *     array named usbDescriptorHidReport1 or usbDescriptorHidReport2.
+ *   USB_CFG_IFACEn_SETUP: name of a function which handles class and vendor
+ *     requests addressed to the interface (wIndex), see usbdrv.h. Requests
+ *     for interfaces without handler go to usbFunctionSetup(). If it returns
+ *     USB_NO_MSG, the data phase goes to usbFunctionRead() or
+ *     usbFunctionWrite(), also with USB_CFG_HAVE_REQUEST_TABLE.
+ * The driver's configuration descriptor contains all interfaces. If you
+ * provide your own, it must have the same layout. Example for a mouse in
+ * interface 1:
+ * #define USB_CFG_IFACE1_CLASS                3
+ * #define USB_CFG_IFACE1_PROTOCOL             2
+ * #define USB_CFG_IFACE1_ENDPOINT             3
+ * #define USB_CFG_IFACE1_HID_REPORT_LENGTH    52
+ * #define USB_CFG_IFACE1_SETUP                mouseSetup
+ */
 
 /* #define USB_PUBLIC static */
 /* Use the define above if you #include usbdrv.c instead of linking against it.
@@ -310,6 +477,17 @@ section at the end of this file).
  *   + USB_PROP_LENGTH(len): If the data is in static memory (RAM or flash),
  *     the driver must know the descriptor's length. The descriptor itself is
  *     found at the address of a well known identifier (see below).
+ *   + USB_PROP_IS_COMPRESSED: The static descriptor in flash memory is
+ *     compressed (see usbdrv.c for the format) and unpacked while it is
+ *     sent. The length is the unpacked length. This saves flash memory
+ *     for strings and large HID report descriptors, but usbPoll() needs
+ *     more cycles per packet. tools/usbdescgen -z generates compressed
+ *     descriptors. Compressed strings are declared as char arrays.
+ *   + USB_PROP_IS_EEPROM: The data returned by usbFunctionDescriptor() or
+ *     found in static memory is in EEPROM. It is read while it is sent, so
+ *     e.g. a serial number programmed per unit needs no copy in RAM. Static
+ *     descriptors in EEPROM must be declared EEMEM. Lengths are limited to
+ *     4095 bytes.
  * List of static descriptor names (must be declared PROGMEM if in flash):
  *   char usbDescriptorDevice[];
  *   char usbDescriptorConfiguration[];
@@ -354,6 +532,23 @@ section at the end of this file).
 #define USB_CFG_DESCR_PROPS_HID                     0
 #define USB_CFG_DESCR_PROPS_HID_REPORT              0
 #define USB_CFG_DESCR_PROPS_UNKNOWN                 0
+#define USB_CFG_DESCR_CRC_TABLES                0
+/* Define this to 1 if your application provides usbDescrCrcTable[] with the
+ * precomputed packet CRCs of its static flash descriptors (see usbdrv.h).
+ * The descriptor generator in tools/usbdescgen writes this table together
+ * with the descriptors and a usbconfig.h fragment which sets this option.
+ * usbPoll() then copies the CRC of each descriptor packet from flash instead
+ * of computing it. This costs 2 bytes of flash per packet plus the lookup.
+ */
+#define USB_CFG_DESCR_CACHE_SIZE                0
+/* Define this to the number of results of usbFunctionDescriptor() which
+ * should be remembered until the next bus reset. Hosts request most
+ * descriptors several times during enumeration, so expensive generators
+ * (e.g. a serial number built from the signature row) run only once. Each
+ * entry costs 8 bytes of RAM (9 with long transfers). Cached data in RAM
+ * must not change until the next bus reset. Replies through
+ * usbFunctionRead() are never cached.
+ */
 
 
 //#define usbMsgPtr_t unsigned short
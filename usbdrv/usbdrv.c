@@ -9,8 +9,8 @@
 
 #include "usbdrv.h"
 #include "oddebug.h"
-#ifdef USB_CFG_USE_INTERRUPT_FREE_IMPL
-#  include <avr/interrupt.h>  /* for sei() */
+#if defined(USB_CFG_USE_INTERRUPT_FREE_IMPL) || USB_CFG_SHARED_TX_BUFFER
+#  include <avr/interrupt.h>  /* for cli() and sei() */
 #endif
 
 /*
@@ -23,14 +23,24 @@ documentation of the entire driver.
 
 /* raw USB registers / interface to assembler code: */
 uchar usbRxBuf[2*USB_BUFSIZE];  /* raw RX buffer: PID, 8 bytes data, 2 bytes CRC */
+#if USB_CFG_FIXED_REGISTERS     /* usbRxLen and usbTxLen are declared in usbdrv.h, initialized in usbInit() */
+register uchar  usbInputBufOffset asm(USB_REG_NAME(USB_REG_INPUT_BUF_OFFSET));
+register uchar  usbDeviceAddr asm(USB_REG_NAME(USB_REG_DEVICE_ADDR));
+register uchar  usbCurrentTok asm(USB_REG_NAME(USB_REG_CURRENT_TOK));
+#else
 uchar       usbInputBufOffset;  /* offset in usbRxBuf used for low level receiving */
 uchar       usbDeviceAddr;      /* assigned during enumeration, defaults to 0 */
+#endif
 uchar       usbNewDeviceAddr;   /* device ID which should be set after status phase */
 uchar       usbConfiguration;   /* currently selected configuration. Administered by driver, but not used */
+#if !USB_CFG_FIXED_REGISTERS
 volatile schar usbRxLen;        /* = 0; number of bytes in usbRxBuf; 0 means free, -1 for flow control */
 uchar       usbCurrentTok;      /* last token received or endpoint number for last OUT token if != 0 */
+#endif
 uchar       usbRxToken;         /* token for data we received; or endpont number for last OUT */
+#if !USB_CFG_FIXED_REGISTERS
 volatile uchar usbTxLen = USBPID_NAK;   /* number of bytes to transmit with next IN token or handshake token */
+#endif
 uchar       usbTxBuf[USB_BUFSIZE];/* data to transmit with next IN, free if usbTxLen contains handshake token */
 #if USB_COUNT_SOF
 volatile uchar  usbSofCount;    /* incremented by assembler module every SOF */
@@ -41,9 +51,24 @@ usbTxStatus_t  usbTxStatus1;
 usbTxStatus_t  usbTxStatus3;
 #   endif
 #endif
-#if USB_CFG_CHECK_DATA_TOGGLING
+#if USB_CFG_SHARED_TX_BUFFER
+static uchar    usbTxToken0;        /* data toggling of endpoint 0, usbTxBuf is shared */
+static uchar    usbScratchBuf[2];   /* replies to standard requests */
+#else
+#define usbTxToken0     usbTxBuf[0]
+#define usbScratchBuf   (usbTxBuf + 9)  /* there are 2 bytes free space at the end of the buffer */
+#endif
+#if USB_CFG_CHECK_DATA_TOGGLING || USB_CFG_FILTER_DATA_TOGGLING
 uchar       usbCurrentDataToken;/* when we check data toggling to ignore duplicate packets */
 #endif
+#if USB_CFG_FILTER_DATA_TOGGLING
+#   if USB_CFG_IMPLEMENT_FN_WRITEOUT
+#       define USB_DATA_TOKEN_SLOTS  16
+#   else
+#       define USB_DATA_TOKEN_SLOTS  1
+#   endif
+uchar       usbLastDataToken[USB_DATA_TOKEN_SLOTS]; /* last data PID accepted per OUT endpoint */
+#endif
 
 /* USB status registers / not shared with asm code */
 usbMsgPtr_t         usbMsgPtr;      /* data to transmit next -- ROM or RAM address */
@@ -51,6 +76,27 @@ static usbMsgLen_t  usbMsgLen = USB_NO_MSG; /* remaining number of bytes */
 uchar               usbMsgFlags;    /* flag values see USB_FLG_* */
 
 #define USB_FLG_USE_USER_RW     (1<<7)
+#define USB_FLG_MSGPTR_IS_COMPRESSED    (1<<4)
+
+#if USB_CFG_HAVE_FAR_FLASH_DATA
+uchar               usbMsgPtrPage;  /* 64 kB page of ROM data at usbMsgPtr */
+#ifndef USB_READ_FLASH_FAR
+#error "USB_CFG_HAVE_FAR_FLASH_DATA requires a device with more than 64 kB of flash memory"
+#endif
+#endif
+
+#if USB_CFG_CLOCK2_KHZ
+uchar               usbClockIndex;  /* receiver selected in usbdrvasm.S */
+#endif
+
+#if USB_CFG_HAVE_MSG_SEGMENTS
+static usbMsgSegment_t  *usbMsgSegment; /* next segment of a segmented reply */
+static uchar            usbSegmentLen;  /* remaining bytes in current segment */
+#endif
+#if USB_CFG_DESCR_CRC_TABLES
+static usbMsgPtr_t  usbMsgCrc;      /* next CRC in flash or 0 if reply has no CRC table */
+static uchar        usbMsgCrcLen;   /* remaining bytes of descriptor covered by usbMsgCrc */
+#endif
 
 /*
 optimizing hints:
@@ -60,17 +106,101 @@ optimizing hints:
 - assign char sized expressions to variables to force 8 bit arithmetics
 */
 
+/* Read a 16 bit value from flash with the same access method as descriptors. */
+#define USB_READ_FLASH_WORD(addr)   \
+    ((uchar)USB_READ_FLASH(addr) | ((unsigned)(uchar)USB_READ_FLASH((char *)(addr) + 1) << 8))
+
+/* USB_PROP_LENGTH() marks lengths which don't fit into the 12 bit field. */
+#if (USB_CFG_DESCR_PROPS_DEVICE | USB_CFG_DESCR_PROPS_CONFIGURATION | USB_CFG_DESCR_PROPS_STRINGS \
+    | USB_CFG_DESCR_PROPS_STRING_0 | USB_CFG_DESCR_PROPS_STRING_VENDOR | USB_CFG_DESCR_PROPS_STRING_PRODUCT \
+    | USB_CFG_DESCR_PROPS_STRING_SERIAL_NUMBER | USB_CFG_DESCR_PROPS_HID | USB_CFG_DESCR_PROPS_HID_REPORT \
+    | USB_CFG_DESCR_PROPS_UNKNOWN) & USB_PROP_LENGTH_OVERFLOW
+#error "USB_PROP_LENGTH() in USB_CFG_DESCR_PROPS_* is limited to 4095 bytes (0x0fff)"
+#endif
+#if USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH > 0x0fff
+#error "USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH is limited to 4095 bytes (0x0fff)"
+#endif
+
+#if USB_CFG_USE_DISPATCH_TABLE
+/* The table based descriptor lookup can't rely on the compiler to remove the
+ * call to usbFunctionDescriptor() for static descriptors. Find out whether
+ * any descriptor is dynamic before the properties of the default descriptors
+ * are redefined to sizeof() expressions below.
+ */
+#if (USB_CFG_DESCR_PROPS_DEVICE | USB_CFG_DESCR_PROPS_CONFIGURATION | USB_CFG_DESCR_PROPS_STRINGS \
+    | USB_CFG_DESCR_PROPS_STRING_0 | USB_CFG_DESCR_PROPS_STRING_VENDOR | USB_CFG_DESCR_PROPS_STRING_PRODUCT \
+    | USB_CFG_DESCR_PROPS_STRING_SERIAL_NUMBER | USB_CFG_DESCR_PROPS_HID | USB_CFG_DESCR_PROPS_HID_REPORT \
+    | USB_CFG_DESCR_PROPS_UNKNOWN) & USB_PROP_IS_DYNAMIC
+#   define USB_HAVE_DYNAMIC_DESCRIPTOR  1
+#endif
+#endif
+
+#if (USB_CFG_DESCR_PROPS_DEVICE | USB_CFG_DESCR_PROPS_CONFIGURATION \
+    | USB_CFG_DESCR_PROPS_STRING_0 | USB_CFG_DESCR_PROPS_STRING_VENDOR | USB_CFG_DESCR_PROPS_STRING_PRODUCT \
+    | USB_CFG_DESCR_PROPS_STRING_SERIAL_NUMBER | USB_CFG_DESCR_PROPS_HID_REPORT) & USB_PROP_IS_COMPRESSED
+#   define USB_HAVE_COMPRESSED_DESCRIPTOR   1
+#endif
+#if (USB_CFG_DESCR_PROPS_CONFIGURATION & USB_PROP_IS_COMPRESSED) && USB_CFG_DESCR_PROPS_HID_REPORT
+#error "The HID descriptor is sent from the configuration descriptor, which must not be compressed"
+#endif
+
+#if USB_CFG_HAVE_EEPROM_DATA || ((USB_CFG_DESCR_PROPS_DEVICE | USB_CFG_DESCR_PROPS_CONFIGURATION \
+    | USB_CFG_DESCR_PROPS_STRING_0 | USB_CFG_DESCR_PROPS_STRING_VENDOR | USB_CFG_DESCR_PROPS_STRING_PRODUCT \
+    | USB_CFG_DESCR_PROPS_STRING_SERIAL_NUMBER | USB_CFG_DESCR_PROPS_HID_REPORT) & USB_PROP_IS_EEPROM)
+#   define USB_HAVE_EEPROM_DATA     1
+#endif
+#if USB_CFG_INTERFACE_COUNT > 1 \
+    && (USB_CFG_DESCR_PROPS_CONFIGURATION & (USB_PROP_IS_DYNAMIC | USB_PROP_IS_COMPRESSED | USB_PROP_IS_EEPROM))
+#error "Composite devices need a static configuration descriptor in flash or RAM memory"
+#endif
+#if (USB_CFG_DESCR_PROPS_CONFIGURATION & USB_PROP_IS_EEPROM) && USB_CFG_DESCR_PROPS_HID_REPORT
+#error "The HID descriptor is sent from the configuration descriptor, which must not be in EEPROM"
+#endif
+
+#if USB_HAVE_COMPRESSED_DESCRIPTOR
+/*
+Compressed descriptors (USB_PROP_IS_COMPRESSED) are a sequence of tokens:
+    0x00...0x3f: n = token + 1 literal bytes follow
+    0x40...0x7f: n = (token & 0x3f) + 1 bytes follow, each is sent followed
+                 by a 0 byte (characters of string descriptors)
+    0x80...0xff, offset: repeat n = (token & 0x7f) + 3 bytes which start
+                 offset + 1 bytes before the token. They must be bytes of
+                 runs of the first kind.
+The decoder needs no buffer since copies refer to data in flash memory.
+*/
+static usbMsgPtr_t  usbUnpackSource;    /* source of current copy token */
+static uchar        usbUnpackToken;     /* current token */
+static uchar        usbUnpackCount;     /* bytes left to send for current token */
+#endif
+
 /* -------------------------- String Descriptors --------------------------- */
 
+#if USB_CFG_STRING_COUNT
+#if (USB_CFG_DESCR_PROPS_STRINGS | USB_CFG_DESCR_PROPS_STRING_0 | USB_CFG_DESCR_PROPS_STRING_VENDOR \
+    | USB_CFG_DESCR_PROPS_STRING_PRODUCT | USB_CFG_DESCR_PROPS_STRING_SERIAL_NUMBER) \
+    & (USB_PROP_IS_DYNAMIC | USB_PROP_IS_RAM | USB_PROP_IS_COMPRESSED | USB_PROP_IS_EEPROM)
+#error "USB_CFG_STRING_COUNT requires all string descriptors uncompressed in flash memory"
+#endif
+#if USB_CFG_STRING_COUNT > 10
+#error "USB_CFG_STRING_COUNT must not exceed 10"
+#endif
+#endif
+
 #if USB_CFG_DESCR_PROPS_STRINGS == 0
 
 #if USB_CFG_DESCR_PROPS_STRING_0 == 0
 #undef USB_CFG_DESCR_PROPS_STRING_0
 #define USB_CFG_DESCR_PROPS_STRING_0    sizeof(usbDescriptorString0)
 PROGMEM const char usbDescriptorString0[] = { /* language descriptor */
+#if USB_CFG_LANGUAGE_COUNT > 1
+    2 + 2 * USB_CFG_LANGUAGE_COUNT, /* sizeof(usbDescriptorString0): length of descriptor in bytes */
+    3,          /* descriptor type */
+    USB_CFG_LANGUAGE_IDS,
+#else
     4,          /* sizeof(usbDescriptorString0): length of descriptor in bytes */
     3,          /* descriptor type */
     0x09, 0x04, /* language index (0x0409 = US-English) */
+#endif
 };
 #endif
 
@@ -101,8 +231,84 @@ PROGMEM const int usbDescriptorStringSerialNumber[] = {
 };
 #endif
 
+#if USB_CFG_STRING_COUNT > 4
+static PROGMEM const int usbDescriptorString4[] = {
+    USB_STRING_DESCRIPTOR_HEADER(USB_CFG_STRING_4_LEN),
+    USB_CFG_STRING_4
+};
+#endif
+#if USB_CFG_STRING_COUNT > 5
+static PROGMEM const int usbDescriptorString5[] = {
+    USB_STRING_DESCRIPTOR_HEADER(USB_CFG_STRING_5_LEN),
+    USB_CFG_STRING_5
+};
+#endif
+#if USB_CFG_STRING_COUNT > 6
+static PROGMEM const int usbDescriptorString6[] = {
+    USB_STRING_DESCRIPTOR_HEADER(USB_CFG_STRING_6_LEN),
+    USB_CFG_STRING_6
+};
+#endif
+#if USB_CFG_STRING_COUNT > 7
+static PROGMEM const int usbDescriptorString7[] = {
+    USB_STRING_DESCRIPTOR_HEADER(USB_CFG_STRING_7_LEN),
+    USB_CFG_STRING_7
+};
+#endif
+#if USB_CFG_STRING_COUNT > 8
+static PROGMEM const int usbDescriptorString8[] = {
+    USB_STRING_DESCRIPTOR_HEADER(USB_CFG_STRING_8_LEN),
+    USB_CFG_STRING_8
+};
+#endif
+#if USB_CFG_STRING_COUNT > 9
+static PROGMEM const int usbDescriptorString9[] = {
+    USB_STRING_DESCRIPTOR_HEADER(USB_CFG_STRING_9_LEN),
+    USB_CFG_STRING_9
+};
+#endif
+
 #endif  /* USB_CFG_DESCR_PROPS_STRINGS == 0 */
 
+#if USB_CFG_STRING_COUNT
+/* String descriptors indexed by string index. Descriptors which don't exist
+ * are NULL. The length is taken from the descriptor's first byte.
+ */
+#define USB_STRING_TABLE_ENTRY(cfgProp, staticName) \
+    ((cfgProp) ? (const int *)(staticName) : (const int *)0)
+
+static PROGMEM const int *const usbStringTable[USB_CFG_STRING_COUNT] = {
+    (const int *)usbDescriptorString0,
+#if USB_CFG_STRING_COUNT > 1
+    USB_STRING_TABLE_ENTRY(USB_CFG_DESCR_PROPS_STRING_VENDOR, usbDescriptorStringVendor),
+#endif
+#if USB_CFG_STRING_COUNT > 2
+    USB_STRING_TABLE_ENTRY(USB_CFG_DESCR_PROPS_STRING_PRODUCT, usbDescriptorStringDevice),
+#endif
+#if USB_CFG_STRING_COUNT > 3
+    USB_STRING_TABLE_ENTRY(USB_CFG_DESCR_PROPS_STRING_SERIAL_NUMBER, usbDescriptorStringSerialNumber),
+#endif
+#if USB_CFG_STRING_COUNT > 4
+    usbDescriptorString4,
+#endif
+#if USB_CFG_STRING_COUNT > 5
+    usbDescriptorString5,
+#endif
+#if USB_CFG_STRING_COUNT > 6
+    usbDescriptorString6,
+#endif
+#if USB_CFG_STRING_COUNT > 7
+    usbDescriptorString7,
+#endif
+#if USB_CFG_STRING_COUNT > 8
+    usbDescriptorString8,
+#endif
+#if USB_CFG_STRING_COUNT > 9
+    usbDescriptorString9,
+#endif
+};
+#endif  /* USB_CFG_STRING_COUNT */
+
 /* --------------------------- Device Descriptor --------------------------- */
 
 #if USB_CFG_DESCR_PROPS_DEVICE == 0
@@ -136,18 +342,57 @@ PROGMEM const char usbDescriptorDevice[] = {    /* USB device descriptor */
 #define USB_CFG_DESCR_PROPS_HID     9   /* length of HID descriptor in config descriptor below */
 #endif
 
+/* Composite devices: interface 0 is described by USB_CFG_INTERFACE_* and has
+ * endpoint 1, interfaces 1 and 2 by USB_CFG_IFACE1_* and USB_CFG_IFACE2_*.
+ * Endpoint 3 belongs to the interface which selects it, interface 0 otherwise.
+ */
+#if USB_CFG_INTERFACE_COUNT > 3
+#error "USB_CFG_INTERFACE_COUNT must not exceed 3"
+#endif
+#if USB_CFG_INTERFACE_COUNT > 1 && USB_CFG_IFACE1_ENDPOINT == 3
+#   define USB_EP3_INTERFACE    1
+#elif USB_CFG_INTERFACE_COUNT > 2 && USB_CFG_IFACE2_ENDPOINT == 3
+#   define USB_EP3_INTERFACE    2
+#else
+#   define USB_EP3_INTERFACE    0
+#endif
+#if USB_EP3_INTERFACE && !USB_CFG_HAVE_INTRIN_ENDPOINT3
+#error "USB_CFG_IFACEn_ENDPOINT 3 requires USB_CFG_HAVE_INTRIN_ENDPOINT3"
+#endif
+
+/* lengths of the interfaces including class and endpoint descriptors */
+#define USB_IFACE0_LENGTH   (9 + (USB_CFG_DESCR_PROPS_HID & 0xff) + 7 * USB_CFG_HAVE_INTRIN_ENDPOINT \
+                            + 7 * (USB_CFG_HAVE_INTRIN_ENDPOINT3 && USB_EP3_INTERFACE == 0))
+#if USB_CFG_INTERFACE_COUNT > 1
+#   define USB_IFACE1_LENGTH    (9 + 9 * (USB_CFG_IFACE1_HID_REPORT_LENGTH != 0) + 7 * (USB_EP3_INTERFACE == 1))
+#else
+#   define USB_IFACE1_LENGTH    0
+#endif
+#if USB_CFG_INTERFACE_COUNT > 2
+#   define USB_IFACE2_LENGTH    (9 + 9 * (USB_CFG_IFACE2_HID_REPORT_LENGTH != 0) + 7 * (USB_EP3_INTERFACE == 2))
+#else
+#   define USB_IFACE2_LENGTH    0
+#endif
+/* offsets of the HID descriptors of interfaces 1 and 2 */
+#define USB_IFACE1_HID_OFFSET   (9 + USB_IFACE0_LENGTH + 9)
+#define USB_IFACE2_HID_OFFSET   (9 + USB_IFACE0_LENGTH + USB_IFACE1_LENGTH + 9)
+
+#define USB_HID_DESCRIPTOR(reportLength)    \
+    9, USBDESCR_HID, 0x01, 0x01, 0x00, 0x01, 0x22, (reportLength) & 0xff, ((reportLength) >> 8) & 0xff
+#define USB_EP3_DESCRIPTOR  \
+    7, USBDESCR_ENDPOINT, (char)(0x80 | USB_CFG_EP3_NUMBER), 0x03, 8, 0, USB_CFG_INTR_POLL_INTERVAL
+
 #if USB_CFG_DESCR_PROPS_CONFIGURATION == 0
 #undef USB_CFG_DESCR_PROPS_CONFIGURATION
 #define USB_CFG_DESCR_PROPS_CONFIGURATION   sizeof(usbDescriptorConfiguration)
 PROGMEM const char usbDescriptorConfiguration[] = {    /* USB configuration descriptor */
     9,          /* sizeof(usbDescriptorConfiguration): length of descriptor in bytes */
     USBDESCR_CONFIG,    /* descriptor type */
-    18 + 7 * USB_CFG_HAVE_INTRIN_ENDPOINT + 7 * USB_CFG_HAVE_INTRIN_ENDPOINT3 +
-                (USB_CFG_DESCR_PROPS_HID & 0xff), 0,
+    9 + USB_IFACE0_LENGTH + USB_IFACE1_LENGTH + USB_IFACE2_LENGTH, 0,
                 /* total length of data returned (including inlined descriptors) */
-    1,          /* number of interfaces in this configuration */
+    USB_CFG_INTERFACE_COUNT,    /* number of interfaces in this configuration */
     1,          /* index of this configuration */
-    0,          /* configuration name string index */
+    USB_CFG_CONFIGURATION_STRING,   /* configuration name string index */
 #if USB_CFG_IS_SELF_POWERED
     (1 << 7) | USBATTR_SELFPOWER,       /* attributes */
 #else
@@ -159,11 +404,11 @@ PROGMEM const char usbDescriptorConfiguration[] = {    /* USB configuration desc
     USBDESCR_INTERFACE, /* descriptor type */
     0,          /* index of this interface */
     0,          /* alternate setting for this interface */
-    USB_CFG_HAVE_INTRIN_ENDPOINT + USB_CFG_HAVE_INTRIN_ENDPOINT3, /* endpoints excl 0: number of endpoint descriptors to follow */
+    USB_CFG_HAVE_INTRIN_ENDPOINT + (USB_CFG_HAVE_INTRIN_ENDPOINT3 && USB_EP3_INTERFACE == 0), /* endpoints excl 0: number of endpoint descriptors to follow */
     USB_CFG_INTERFACE_CLASS,
     USB_CFG_INTERFACE_SUBCLASS,
     USB_CFG_INTERFACE_PROTOCOL,
-    0,          /* string index for interface */
+    USB_CFG_INTERFACE_STRING,       /* string index for interface */
 #if (USB_CFG_DESCR_PROPS_HID & 0xff)    /* HID descriptor */
     9,          /* sizeof(usbDescrHID): length of descriptor in bytes */
     USBDESCR_HID,   /* descriptor type: HID */
@@ -182,7 +427,7 @@ PROGMEM const char usbDescriptorConfiguration[] = {    /* USB configuration desc
     8, 0,       /* maximum packet size */
     USB_CFG_INTR_POLL_INTERVAL, /* in ms */
 #endif
-#if USB_CFG_HAVE_INTRIN_ENDPOINT3   /* endpoint descriptor for endpoint 3 */
+#if USB_CFG_HAVE_INTRIN_ENDPOINT3 && USB_EP3_INTERFACE == 0 /* endpoint descriptor for endpoint 3 */
     7,          /* sizeof(usbDescrEndpoint) */
     USBDESCR_ENDPOINT,  /* descriptor type = endpoint */
     (char)(0x80 | USB_CFG_EP3_NUMBER), /* IN endpoint number 3 */
@@ -190,13 +435,71 @@ PROGMEM const char usbDescriptorConfiguration[] = {    /* USB configuration desc
     8, 0,       /* maximum packet size */
     USB_CFG_INTR_POLL_INTERVAL, /* in ms */
 #endif
+#if USB_CFG_INTERFACE_COUNT > 1     /* interface 1 of composite device */
+    9, USBDESCR_INTERFACE, 1, 0, USB_EP3_INTERFACE == 1,
+    USB_CFG_IFACE1_CLASS, USB_CFG_IFACE1_SUBCLASS, USB_CFG_IFACE1_PROTOCOL, 0,
+#if USB_CFG_IFACE1_HID_REPORT_LENGTH
+    USB_HID_DESCRIPTOR(USB_CFG_IFACE1_HID_REPORT_LENGTH),
+#endif
+#if USB_EP3_INTERFACE == 1
+    USB_EP3_DESCRIPTOR,
+#endif
+#endif
+#if USB_CFG_INTERFACE_COUNT > 2     /* interface 2 of composite device */
+    9, USBDESCR_INTERFACE, 2, 0, USB_EP3_INTERFACE == 2,
+    USB_CFG_IFACE2_CLASS, USB_CFG_IFACE2_SUBCLASS, USB_CFG_IFACE2_PROTOCOL, 0,
+#if USB_CFG_IFACE2_HID_REPORT_LENGTH
+    USB_HID_DESCRIPTOR(USB_CFG_IFACE2_HID_REPORT_LENGTH),
+#endif
+#if USB_EP3_INTERFACE == 2
+    USB_EP3_DESCRIPTOR,
+#endif
+#endif
 };
 #endif
 
+#if USB_CFG_INTERFACE_COUNT > 1
+/* Return the HID or report descriptor of interface 1 or 2. Interface 0 is
+ * handled by usbDriverDescriptor() as in devices with one interface.
+ */
+static usbMsgLen_t usbInterfaceDescriptor(usbRequest_t *rq)
+{
+    usbMsgFlags = (USB_CFG_DESCR_PROPS_CONFIGURATION & USB_PROP_IS_RAM) ? 0 : USB_FLG_MSGPTR_IS_ROM;
+#if USB_CFG_IFACE1_HID_REPORT_LENGTH
+    if(rq->wIndex.bytes[0] == 1){
+        if(rq->wValue.bytes[1] == USBDESCR_HID_REPORT){
+            usbMsgFlags = USB_FLG_MSGPTR_IS_ROM;
+            usbMsgPtr = (usbMsgPtr_t)usbDescriptorHidReport1;
+            return USB_CFG_IFACE1_HID_REPORT_LENGTH;
+        }
+        usbMsgPtr = (usbMsgPtr_t)(usbDescriptorConfiguration + USB_IFACE1_HID_OFFSET);
+        return 9;
+    }
+#endif
+#if USB_CFG_INTERFACE_COUNT > 2 && USB_CFG_IFACE2_HID_REPORT_LENGTH
+    if(rq->wIndex.bytes[0] == 2){
+        if(rq->wValue.bytes[1] == USBDESCR_HID_REPORT){
+            usbMsgFlags = USB_FLG_MSGPTR_IS_ROM;
+            usbMsgPtr = (usbMsgPtr_t)usbDescriptorHidReport2;
+            return USB_CFG_IFACE2_HID_REPORT_LENGTH;
+        }
+        usbMsgPtr = (usbMsgPtr_t)(usbDescriptorConfiguration + USB_IFACE2_HID_OFFSET);
+        return 9;
+    }
+#endif
+    return 0;
+}
+#endif
+
 /* ------------------------------------------------------------------------- */
 
 static inline void  usbResetDataToggling(void)
 {
+#if USB_CFG_FILTER_DATA_TOGGLING && USB_CFG_IMPLEMENT_FN_WRITEOUT
+uchar   i;
+    for(i = 1; i < USB_DATA_TOKEN_SLOTS; i++)
+        usbLastDataToken[i] = USBPID_DATA1; /* next packet is expected with DATA0 */
+#endif
 #if USB_CFG_HAVE_INTRIN_ENDPOINT && !USB_CFG_SUPPRESS_INTR_CODE
     USB_SET_DATATOKEN1(USB_INITIAL_DATATOKEN);  /* reset data toggling for interrupt endpoint */
 #   if USB_CFG_HAVE_INTRIN_ENDPOINT3
@@ -205,6 +508,26 @@ static inline void  usbResetDataToggling(void)
 #endif
 }
 
+#if USB_CFG_FILTER_DATA_TOGGLING
+/* Returns 1 if the received packet carries the same data PID as the last one
+ * accepted on its endpoint: the host has missed our ACK and repeats it.
+ * SETUP is always accepted and restarts endpoint 0 with DATA0.
+ */
+static inline uchar usbIsDuplicate(void)
+{
+uchar   i = 0;
+
+#if USB_CFG_IMPLEMENT_FN_WRITEOUT
+    if(usbRxToken < 0x10)   /* OUT to endpoint != 0 */
+        i = usbRxToken;
+#endif
+    if(usbRxToken != (uchar)USBPID_SETUP && usbLastDataToken[i] == usbCurrentDataToken)
+        return 1;
+    usbLastDataToken[i] = usbCurrentDataToken;
+    return 0;
+}
+#endif
+
 static inline void  usbResetStall(void)
 {
 #if USB_CFG_IMPLEMENT_HALT && USB_CFG_HAVE_INTRIN_ENDPOINT
@@ -215,6 +538,38 @@ static inline void  usbResetStall(void)
 #endif
 }
 
+#if USB_CFG_SHARED_TX_BUFFER
+uchar   usbIntrDropped;
+
+/* Endpoint 0 has priority over the interrupt endpoints in the shared transmit
+ * buffer: an interrupt packet which is still pending when a control transfer
+ * needs the buffer for its reply or when a bus reset arrives is dropped,
+ * otherwise the host could never collect the control-in data if it doesn't
+ * poll the interrupt endpoint. The data token is toggled back since the
+ * packet was not sent, and the endpoint's bit in usbIntrDropped is set.
+ */
+static void usbDropIntrPacket(usbTxStatus_t *txStatus, uchar flag)
+{
+uchar   sreg = SREG;
+
+    cli();  /* the interrupt routine may send the packet meanwhile */
+    if(!(txStatus->len & 0x10)){
+        txStatus->len = USBPID_NAK;
+        txStatus->dataToken ^= USBPID_DATA0 ^ USBPID_DATA1;
+        usbIntrDropped |= flag;
+    }
+    SREG = sreg;
+}
+
+static inline void  usbDropIntrPackets(void)
+{
+    usbDropIntrPacket(&usbTxStatus1, 1 << 1);
+#if USB_CFG_HAVE_INTRIN_ENDPOINT3
+    usbDropIntrPacket(&usbTxStatus3, 1 << 3);
+#endif
+}
+#endif
+
 /* ------------------------------------------------------------------------- */
 
 #if !USB_CFG_SUPPRESS_INTR_CODE
@@ -228,19 +583,34 @@ schar   i;
     if(usbTxLen1 == USBPID_STALL)
         return;
 #endif
+#if USB_CFG_SHARED_TX_BUFFER
+uchar   *buffer = usbTxBuf;
+
+    if(txStatus->len & 0x10){   /* no packet of this endpoint pending */
+        if(!usbInterruptIsReady())  /* not configured or buffer holds packet of other endpoint */
+            return;
+        txStatus->dataToken ^= USBPID_DATA0 ^ USBPID_DATA1; /* toggle token */
+    }else{
+        txStatus->len = USBPID_NAK; /* avoid sending outdated (overwritten) interrupt data */
+    }
+    buffer[0] = txStatus->dataToken;
+#else
+uchar   *buffer = txStatus->buffer;
+
     if(txStatus->len & 0x10){   /* packet buffer was empty */
-        txStatus->buffer[0] ^= USBPID_DATA0 ^ USBPID_DATA1; /* toggle token */
+        buffer[0] ^= USBPID_DATA0 ^ USBPID_DATA1; /* toggle token */
     }else{
         txStatus->len = USBPID_NAK; /* avoid sending outdated (overwritten) interrupt data */
     }
-    p = txStatus->buffer + 1;
+#endif
+    p = buffer + 1;
     i = len;
     do{                         /* if len == 0, we still copy 1 byte, but that's no problem */
         *p++ = *data++;
     }while(--i > 0);            /* loop control at the end is 2 bytes shorter than at beginning */
-    usbCrc16Append(&txStatus->buffer[1], len);
+    usbCrc16Append(&buffer[1], len);
     txStatus->len = len + 4;    /* len must be given including sync byte */
-    DBG2(0x21 + (((int)txStatus >> 3) & 3), txStatus->buffer, len + 3);
+    DBG2(0x21 + (((int)txStatus >> 3) & 3), buffer, len + 3);
 }
 
 USB_PUBLIC void usbSetInterrupt(uchar *data, uchar len)
@@ -289,6 +659,74 @@ USB_PUBLIC void usbSetInterrupt3(uchar *data, uchar len)
 
 /* ------------------------------------------------------------------------- */
 
+#if USB_CFG_DESCR_CACHE_SIZE
+/* Results of usbFunctionDescriptor() are remembered until the next bus
+ * reset, so that the host's repeated requests during enumeration don't run
+ * the generator again. Entries with len == 0 are unused.
+ */
+typedef struct usbDescrCacheEntry{
+    unsigned    wValue;
+    unsigned    wIndex;
+    usbMsgPtr_t ptr;
+    usbMsgLen_t len;
+    uchar       flags;
+#if USB_CFG_HAVE_FAR_FLASH_DATA
+    uchar       page;   /* usbMsgPtrPage of ROM data */
+#endif
+}usbDescrCacheEntry_t;
+
+static usbDescrCacheEntry_t usbDescrCache[USB_CFG_DESCR_CACHE_SIZE];
+static uchar                usbDescrCacheNext;  /* entry replaced next */
+
+static usbMsgLen_t usbDynamicDescriptor(usbRequest_t *rq)
+{
+usbDescrCacheEntry_t    *entry = usbDescrCache;
+uchar                   i;
+usbMsgLen_t             len;
+
+    for(i = USB_CFG_DESCR_CACHE_SIZE; i != 0; i--){
+        if(entry->len != 0 && entry->wValue == rq->wValue.word && entry->wIndex == rq->wIndex.word){
+            usbMsgPtr = entry->ptr;
+            usbMsgFlags = entry->flags;
+#if USB_CFG_HAVE_FAR_FLASH_DATA
+            usbMsgPtrPage = entry->page;
+#endif
+            return entry->len;
+        }
+        entry++;
+    }
+    len = usbFunctionDescriptor(rq);
+    if(len != 0 && len != USB_NO_MSG){  /* usbFunctionRead() replies can't be cached */
+        i = usbDescrCacheNext;
+        entry = &usbDescrCache[i];
+        if(++i >= USB_CFG_DESCR_CACHE_SIZE)
+            i = 0;
+        usbDescrCacheNext = i;
+        entry->wValue = rq->wValue.word;
+        entry->wIndex = rq->wIndex.word;
+        entry->ptr = usbMsgPtr;
+        entry->len = len;
+        entry->flags = usbMsgFlags;
+#if USB_CFG_HAVE_FAR_FLASH_DATA
+        entry->page = usbMsgPtrPage;
+#endif
+    }
+    return len;
+}
+
+static inline void  usbFlushDescrCache(void)
+{
+uchar   i;
+
+    for(i = 0; i < USB_CFG_DESCR_CACHE_SIZE; i++)
+        usbDescrCache[i].len = 0;
+}
+#else
+#define usbDynamicDescriptor(rq)    usbFunctionDescriptor(rq)
+#endif
+
+/* ------------------------------------------------------------------------- */
+
 /* We use if() instead of #if in the macro below because #if can't be used
  * in macros and the compiler optimizes constant conditions anyway.
  * This may cause problems with undefined symbols if compiled without
@@ -298,14 +736,162 @@ USB_PUBLIC void usbSetInterrupt3(uchar *data, uchar len)
     if(cfgProp){                                    \
         if((cfgProp) & USB_PROP_IS_RAM)             \
             flags = 0;                              \
+        if((cfgProp) & USB_PROP_IS_COMPRESSED)      \
+            flags = USB_FLG_MSGPTR_IS_COMPRESSED;   \
+        if((cfgProp) & USB_PROP_IS_EEPROM)          \
+            flags = USB_FLG_MSGPTR_IS_EEPROM;       \
         if((cfgProp) & USB_PROP_IS_DYNAMIC){        \
-            len = usbFunctionDescriptor(rq);        \
+            len = usbDynamicDescriptor(rq);         \
         }else{                                      \
-            len = USB_PROP_LENGTH(cfgProp);         \
+            len = USB_PROP_LENGTH_OF(cfgProp);      \
             usbMsgPtr = (usbMsgPtr_t)(staticName);  \
         }                                           \
     }
 
+#if USB_CFG_STRING_COUNT
+/* Look up a string descriptor in usbStringTable. The caller must check that
+ * the string index is less than USB_CFG_STRING_COUNT.
+ */
+static inline usbMsgLen_t usbDriverString(usbRequest_t *rq)
+{
+uchar       index = rq->wValue.bytes[0];
+const char  *p;
+
+#if USB_CFG_LANGUAGE_COUNT > 1
+    p = 0;
+    if(index != 0){
+        const char  *languageId = usbDescriptorString0 + 4; /* skip header and first language */
+        uchar       i;
+        for(i = 0; i < USB_CFG_LANGUAGE_COUNT - 1; i++){
+            if((uchar)USB_READ_FLASH(languageId) == rq->wIndex.bytes[0]
+                    && (uchar)USB_READ_FLASH(languageId + 1) == rq->wIndex.bytes[1]){
+                p = (const char *)USB_READ_FLASH_WORD(&usbStringTableLanguages[i][index]);
+                break;
+            }
+            languageId += 2;
+        }
+    }
+    if(p == 0)  /* first language or no translation */
+        p = (const char *)USB_READ_FLASH_WORD(&usbStringTable[index]);
+#else
+    p = (const char *)USB_READ_FLASH_WORD(&usbStringTable[index]);
+#endif
+    usbMsgPtr = (usbMsgPtr_t)p;
+    if(p == 0)
+        return 0;
+    return (uchar)USB_READ_FLASH(p);    /* bLength */
+}
+#endif  /* USB_CFG_STRING_COUNT */
+
+#if USB_CFG_USE_DISPATCH_TABLE
+
+typedef struct usbDescrTableEntry{
+    const char  *ptr;   /* descriptor data, NULL if dynamic or not present */
+    unsigned    props;  /* USB_CFG_DESCR_PROPS_* value */
+}usbDescrTableEntry_t;
+
+/* Pointers of dynamic descriptors are never used. The conditional expressions
+ * ensure that we don't reference descriptors which don't exist.
+ */
+#define USB_DESCR_TABLE_ENTRY(cfgProp, staticName)  \
+    {((cfgProp) && !((cfgProp) & USB_PROP_IS_DYNAMIC)) ? (const char *)(staticName) : (const char *)0, (cfgProp)}
+
+/* Indices into usbDescrTable[] */
+#define USB_DESCR_INDEX_UNKNOWN     0
+#define USB_DESCR_INDEX_STRING      3   /* followed by string 1 to 3 */
+#if USB_CFG_DESCR_PROPS_STRINGS & USB_PROP_IS_DYNAMIC
+#define USB_DESCR_INDEX_HID         4   /* one entry for all strings */
+#elif USB_CFG_STRING_COUNT          /* strings are in usbStringTable */
+#define USB_DESCR_INDEX_HID         3
+#else
+#define USB_DESCR_INDEX_HID         7
+#endif
+
+static PROGMEM const usbDescrTableEntry_t usbDescrTable[] = {
+    {(const char *)0, USB_CFG_DESCR_PROPS_UNKNOWN},
+    USB_DESCR_TABLE_ENTRY(USB_CFG_DESCR_PROPS_DEVICE, usbDescriptorDevice),                     /* 1 */
+    USB_DESCR_TABLE_ENTRY(USB_CFG_DESCR_PROPS_CONFIGURATION, usbDescriptorConfiguration),       /* 2 */
+#if USB_CFG_DESCR_PROPS_STRINGS & USB_PROP_IS_DYNAMIC
+    {(const char *)0, USB_CFG_DESCR_PROPS_STRINGS},                                            /* 3 */
+#elif !USB_CFG_STRING_COUNT
+    USB_DESCR_TABLE_ENTRY(USB_CFG_DESCR_PROPS_STRING_0, usbDescriptorString0),                  /* 3 */
+    USB_DESCR_TABLE_ENTRY(USB_CFG_DESCR_PROPS_STRING_VENDOR, usbDescriptorStringVendor),
+    USB_DESCR_TABLE_ENTRY(USB_CFG_DESCR_PROPS_STRING_PRODUCT, usbDescriptorStringDevice),
+    USB_DESCR_TABLE_ENTRY(USB_CFG_DESCR_PROPS_STRING_SERIAL_NUMBER, usbDescriptorStringSerialNumber),
+#endif
+#if USB_CFG_DESCR_PROPS_HID_REPORT
+    USB_DESCR_TABLE_ENTRY(USB_CFG_DESCR_PROPS_HID, usbDescriptorConfiguration + 18),            /* USB_DESCR_INDEX_HID */
+    USB_DESCR_TABLE_ENTRY(USB_CFG_DESCR_PROPS_HID_REPORT, usbDescriptorHidReport),
+#endif
+};
+
+#if USB_CFG_DESCR_PROPS_HID_REPORT
+/* compile time check: USB_DESCR_INDEX_HID must match the #if chain above */
+typedef char usbDescrIndexHidCheck[(sizeof(usbDescrTable) / sizeof(usbDescrTable[0]) == USB_DESCR_INDEX_HID + 2) ? 1 : -1];
+#endif
+
+/* Table based version of usbDriverDescriptor(): the descriptor type and
+ * string index are mapped to a table index and the properties are evaluated
+ * at run time, with one common code path for all descriptors.
+ */
+static inline usbMsgLen_t usbDriverDescriptor(usbRequest_t *rq)
+{
+usbMsgLen_t len;
+unsigned    props;
+uchar       type = rq->wValue.bytes[1], index = USB_DESCR_INDEX_UNKNOWN;
+const usbDescrTableEntry_t  *entry;
+
+#if USB_CFG_INTERFACE_COUNT > 1
+    if(rq->wIndex.bytes[0] != 0 && (uchar)(type - USBDESCR_HID) < 2)
+        return usbInterfaceDescriptor(rq);
+#endif
+    if(type == USBDESCR_STRING){
+#if USB_CFG_DESCR_PROPS_STRINGS & USB_PROP_IS_DYNAMIC
+        index = USB_DESCR_INDEX_STRING;
+#elif USB_CFG_STRING_COUNT
+        if(rq->wValue.bytes[0] < USB_CFG_STRING_COUNT){
+            usbMsgFlags = USB_FLG_MSGPTR_IS_ROM;
+            return usbDriverString(rq);
+        }
+#else
+        uchar stringIndex = rq->wValue.bytes[0];
+        if(stringIndex < 4)
+            index = USB_DESCR_INDEX_STRING + stringIndex;
+#endif
+    }else if(type <= USBDESCR_CONFIG){  /* 0 maps to unknown */
+        index = type;
+#if USB_CFG_DESCR_PROPS_HID_REPORT
+    }else{
+        type -= USBDESCR_HID;
+        if(type < 2)
+            index = USB_DESCR_INDEX_HID + type;
+#endif
+    }
+    entry = &usbDescrTable[index];
+    props = USB_READ_FLASH_WORD(&entry->props);
+    usbMsgFlags = (props & USB_PROP_IS_RAM) ? 0 : USB_FLG_MSGPTR_IS_ROM;
+#if USB_HAVE_COMPRESSED_DESCRIPTOR
+    if(props & USB_PROP_IS_COMPRESSED)
+        usbMsgFlags = USB_FLG_MSGPTR_IS_COMPRESSED;
+#endif
+#if USB_HAVE_EEPROM_DATA
+    if(props & USB_PROP_IS_EEPROM)
+        usbMsgFlags = USB_FLG_MSGPTR_IS_EEPROM;
+#endif
+#if USB_HAVE_DYNAMIC_DESCRIPTOR
+    if(props & USB_PROP_IS_DYNAMIC){
+        len = usbDynamicDescriptor(rq);
+    }else
+#endif
+    {
+        len = USB_PROP_LENGTH_OF(props);
+        usbMsgPtr = (usbMsgPtr_t)USB_READ_FLASH_WORD(&entry->ptr);
+    }
+    return len;
+}
+
+#else   /* USB_CFG_USE_DISPATCH_TABLE */
+
 /* usbDriverDescriptor() is similar to usbFunctionDescriptor(), but used
  * internally for all types of descriptors.
  */
@@ -314,6 +900,10 @@ static inline usbMsgLen_t usbDriverDescriptor(usbRequest_t *rq)
 usbMsgLen_t len = 0;
 uchar       flags = USB_FLG_MSGPTR_IS_ROM;
 
+#if USB_CFG_INTERFACE_COUNT > 1
+    if(rq->wIndex.bytes[0] != 0 && (uchar)(rq->wValue.bytes[1] - USBDESCR_HID) < 2)
+        return usbInterfaceDescriptor(rq);
+#endif
     SWITCH_START(rq->wValue.bytes[1])
     SWITCH_CASE(USBDESCR_DEVICE)    /* 1 */
         GET_DESCRIPTOR(USB_CFG_DESCR_PROPS_DEVICE, usbDescriptorDevice)
@@ -323,7 +913,16 @@ uchar       flags = USB_FLG_MSGPTR_IS_ROM;
 #if USB_CFG_DESCR_PROPS_STRINGS & USB_PROP_IS_DYNAMIC
         if(USB_CFG_DESCR_PROPS_STRINGS & USB_PROP_IS_RAM)
             flags = 0;
-        len = usbFunctionDescriptor(rq);
+        len = usbDynamicDescriptor(rq);
+#elif USB_CFG_STRING_COUNT
+        if(rq->wValue.bytes[0] < USB_CFG_STRING_COUNT){
+            len = usbDriverString(rq);
+        }else if(USB_CFG_DESCR_PROPS_UNKNOWN & USB_PROP_IS_DYNAMIC){
+            if(USB_CFG_DESCR_PROPS_UNKNOWN & USB_PROP_IS_RAM){
+                flags = 0;
+            }
+            len = usbDynamicDescriptor(rq);
+        }
 #else   /* USB_CFG_DESCR_PROPS_STRINGS & USB_PROP_IS_DYNAMIC */
         SWITCH_START(rq->wValue.bytes[0])
         SWITCH_CASE(0)
@@ -339,7 +938,7 @@ uchar       flags = USB_FLG_MSGPTR_IS_ROM;
                 if(USB_CFG_DESCR_PROPS_UNKNOWN & USB_PROP_IS_RAM){
                     flags = 0;
                 }
-                len = usbFunctionDescriptor(rq);
+                len = usbDynamicDescriptor(rq);
             }
         SWITCH_END
 #endif  /* USB_CFG_DESCR_PROPS_STRINGS & USB_PROP_IS_DYNAMIC */
@@ -354,22 +953,139 @@ uchar       flags = USB_FLG_MSGPTR_IS_ROM;
             if(USB_CFG_DESCR_PROPS_UNKNOWN & USB_PROP_IS_RAM){
                 flags = 0;
             }
-            len = usbFunctionDescriptor(rq);
+            len = usbDynamicDescriptor(rq);
         }
     SWITCH_END
     usbMsgFlags = flags;
     return len;
 }
 
+#endif  /* USB_CFG_USE_DISPATCH_TABLE */
+
 /* ------------------------------------------------------------------------- */
 
+#if USB_CFG_USE_DISPATCH_TABLE
+
+/* Handlers for standard requests. They are called with usbMsgPtr pointing to
+ * a 2 byte scratch buffer, the first byte cleared.
+ */
+typedef usbMsgLen_t (*usbStdRqHandler_t)(usbRequest_t *rq);
+
+static usbMsgLen_t  usbStdRqIgnore(usbRequest_t *rq)
+{
+    return 0;
+}
+
+static usbMsgLen_t  usbStdRqGetStatus(usbRequest_t *rq)
+{
+uchar   *dataPtr = usbScratchBuf;
+uchar   recipient = rq->bmRequestType & USBRQ_RCPT_MASK;
+
+    if(USB_CFG_IS_SELF_POWERED && recipient == USBRQ_RCPT_DEVICE)
+        dataPtr[0] =  USB_CFG_IS_SELF_POWERED;
+#if USB_CFG_IMPLEMENT_HALT
+    if(recipient == USBRQ_RCPT_ENDPOINT && rq->wIndex.bytes[0] == 0x81)   /* request status for endpoint 1 */
+        dataPtr[0] = usbTxLen1 == USBPID_STALL;
+#endif
+    dataPtr[1] = 0;
+    return 2;
+}
+
+#if USB_CFG_IMPLEMENT_HALT
+static usbMsgLen_t  usbStdRqFeature(usbRequest_t *rq)
+{
+    if(rq->wValue.bytes[0] == 0 && rq->wIndex.bytes[0] == 0x81){    /* feature 0 == HALT for endpoint == 1 */
+        usbTxLen1 = rq->bRequest == USBRQ_CLEAR_FEATURE ? USBPID_NAK : USBPID_STALL;
+        usbResetDataToggling();
+    }
+    return 0;
+}
+#else
+#define usbStdRqFeature     usbStdRqIgnore
+#endif
+
+static usbMsgLen_t  usbStdRqSetAddress(usbRequest_t *rq)
+{
+    usbNewDeviceAddr = rq->wValue.bytes[0];
+    USB_SET_ADDRESS_HOOK();
+    return 0;
+}
+
+static usbMsgLen_t  usbStdRqGetDescriptor(usbRequest_t *rq)
+{
+    return usbDriverDescriptor(rq);
+}
+
+static usbMsgLen_t  usbStdRqGetConfiguration(usbRequest_t *rq)
+{
+    usbMsgPtr = (usbMsgPtr_t)&usbConfiguration;  /* send current configuration value */
+    return 1;
+}
+
+static usbMsgLen_t  usbStdRqSetConfiguration(usbRequest_t *rq)
+{
+    usbConfiguration = rq->wValue.bytes[0];
+    usbResetStall();
+    return 0;
+}
+
+static usbMsgLen_t  usbStdRqGetInterface(usbRequest_t *rq)
+{
+    return 1;
+}
+
+#if USB_CFG_HAVE_INTRIN_ENDPOINT && !USB_CFG_SUPPRESS_INTR_CODE
+static usbMsgLen_t  usbStdRqSetInterface(usbRequest_t *rq)
+{
+    usbResetDataToggling();
+    usbResetStall();
+    return 0;
+}
+#else
+#define usbStdRqSetInterface    usbStdRqIgnore
+#endif
+
+static PROGMEM const usbStdRqHandler_t usbStdRqTable[] = {
+    usbStdRqGetStatus,          /* 0 = USBRQ_GET_STATUS */
+    usbStdRqFeature,            /* 1 = USBRQ_CLEAR_FEATURE */
+    usbStdRqIgnore,             /* 2 reserved */
+    usbStdRqFeature,            /* 3 = USBRQ_SET_FEATURE */
+    usbStdRqIgnore,             /* 4 reserved */
+    usbStdRqSetAddress,         /* 5 = USBRQ_SET_ADDRESS */
+    usbStdRqGetDescriptor,      /* 6 = USBRQ_GET_DESCRIPTOR */
+    usbStdRqIgnore,             /* 7 = USBRQ_SET_DESCRIPTOR */
+    usbStdRqGetConfiguration,   /* 8 = USBRQ_GET_CONFIGURATION */
+    usbStdRqSetConfiguration,   /* 9 = USBRQ_SET_CONFIGURATION */
+    usbStdRqGetInterface,       /* 10 = USBRQ_GET_INTERFACE */
+    usbStdRqSetInterface,       /* 11 = USBRQ_SET_INTERFACE */
+};                              /* 12 = SYNCH_FRAME and above are ignored */
+
+/* Table based version of usbDriverSetup(): one bounds check and an indirect
+ * call instead of a chain of comparisons.
+ */
+static inline usbMsgLen_t usbDriverSetup(usbRequest_t *rq)
+{
+uchar               *dataPtr = usbScratchBuf;
+uchar               request = rq->bRequest;
+usbStdRqHandler_t   handler;
+
+    if(request >= sizeof(usbStdRqTable) / sizeof(usbStdRqTable[0]))
+        return 0;
+    dataPtr[0] = 0; /* default reply common to USBRQ_GET_STATUS and USBRQ_GET_INTERFACE */
+    usbMsgPtr = (usbMsgPtr_t)dataPtr;
+    handler = (usbStdRqHandler_t)USB_READ_FLASH_WORD(&usbStdRqTable[request]);
+    return handler(rq);
+}
+
+#else   /* USB_CFG_USE_DISPATCH_TABLE */
+
 /* usbDriverSetup() is similar to usbFunctionSetup(), but it's used for
  * standard requests instead of class and custom requests.
  */
 static inline usbMsgLen_t usbDriverSetup(usbRequest_t *rq)
 {
 usbMsgLen_t len = 0;
-uchar   *dataPtr = usbTxBuf + 9;    /* there are 2 bytes free space at the end of the buffer */
+uchar   *dataPtr = usbScratchBuf;
 uchar   value = rq->wValue.bytes[0];
 #if USB_CFG_IMPLEMENT_HALT
 uchar   index = rq->wIndex.bytes[0];
@@ -421,8 +1137,150 @@ skipMsgPtrAssignment:
     return len;
 }
 
+#endif  /* USB_CFG_USE_DISPATCH_TABLE */
+
+/* ------------------------------------------------------------------------- */
+
+#if USB_CFG_HAVE_REQUEST_TABLE
+
+static usbRequestStream_t   usbRqStream;    /* data phase function of current transfer */
+static uchar                usbRqWriteLen;  /* remaining space for USB_RQKIND_RAM control-out */
+
+/* Data phase of a USB_RQKIND_RAM control-out transfer: store data at usbMsgPtr. */
+static uchar usbRequestWriteRam(uchar *data, uchar len)
+{
+uchar   *p = (uchar *)usbMsgPtr;
+uchar   i = usbRqWriteLen;
+
+    if(len > i)
+        len = i;
+    usbRqWriteLen = i - len;
+    while(len--)
+        *p++ = *data++;
+    usbMsgPtr = (usbMsgPtr_t)p;
+    return usbRqWriteLen == 0;
+}
+
+/* Handlers which return USB_NO_MSG stream their data with usbFunctionRead()
+ * or usbFunctionWrite(), as without the request table.
+ */
+static inline void usbRequestUserStream(usbRequest_t *rq)
+{
+#if USB_CFG_IMPLEMENT_FN_READ
+    if(rq->bmRequestType & USBRQ_DIR_MASK)
+        usbRqStream = usbFunctionRead;
+#endif
+#if USB_CFG_IMPLEMENT_FN_WRITE
+    if(!(rq->bmRequestType & USBRQ_DIR_MASK))
+        usbRqStream = usbFunctionWrite;
+#endif
+}
+
+/* usbRequestSetup() is called instead of usbFunctionSetup(). It looks up the
+ * request in the application's usbRequestTable with a binary search.
+ */
+static inline usbMsgLen_t usbRequestSetup(usbRequest_t *rq)
+{
+unsigned    key = ((rq->bmRequestType & ~USBRQ_DIR_MASK) << 8) | rq->bRequest;
+uchar       lo = 0, hi = USB_READ_FLASH(&usbRequestTableSize);
+
+    usbRequestUserStream(rq);   /* in case a handler returns USB_NO_MSG */
+    while(lo < hi){
+        uchar                   mid = (uchar)((lo + hi) >> 1);
+        const usbRequestEntry_t *entry = &usbRequestTable[mid];
+        unsigned                entryKey = ((uchar)USB_READ_FLASH(&entry->bmRequestType) << 8)
+                                            | (uchar)USB_READ_FLASH(&entry->bRequest);
+        if(key > entryKey){
+            lo = mid + 1;
+        }else if(key < entryKey){
+            hi = mid;
+        }else{
+            uchar   kind = USB_READ_FLASH(&entry->kind);
+            uchar   len = USB_READ_FLASH(&entry->len);
+            void    *ptr = (void *)USB_READ_FLASH_WORD(&entry->ptr);
+            if(kind == USB_RQKIND_HANDLER)
+                return ((usbRequestHandler_t)ptr)(rq);
+            if(kind == USB_RQKIND_STREAM){
+                usbRqStream = (usbRequestStream_t)ptr;
+                return USB_NO_MSG;
+            }
+            usbMsgPtr = (usbMsgPtr_t)ptr;
+            if(rq->bmRequestType & USBRQ_DIR_MASK){ /* control-in */
+                if(kind == USB_RQKIND_ROM)
+                    usbMsgFlags = USB_FLG_MSGPTR_IS_ROM;
+                return len;
+            }
+            if(kind == USB_RQKIND_ROM)
+                return 0;
+            if(!rq->wLength.bytes[1] && len > rq->wLength.bytes[0])
+                len = rq->wLength.bytes[0];
+            if(len == 0)    /* no data phase */
+                return 0;
+            usbRqWriteLen = len;
+            usbRqStream = usbRequestWriteRam;
+            return USB_NO_MSG;
+        }
+    }
+#if USB_CFG_HAVE_REQUEST_TABLE > 1  /* fall back to usbFunctionSetup() */
+    return usbFunctionSetup((uchar *)rq);
+#else
+    return 0;
+#endif
+}
+
+#endif  /* USB_CFG_HAVE_REQUEST_TABLE */
+
 /* ------------------------------------------------------------------------- */
 
+#if USB_CFG_DESCR_CRC_TABLES
+/* Find the CRC table of the flash memory reply at usbMsgPtr, if any. */
+static void usbFindCrcTable(void)
+{
+const usbDescrCrcEntry_t    *entry = usbDescrCrcTable;
+uchar                       i;
+
+    usbMsgCrc = 0;
+    for(i = USB_READ_FLASH(&usbDescrCrcTableSize); i != 0; i--){
+        if((usbMsgPtr_t)USB_READ_FLASH_WORD(&entry->descriptor) == usbMsgPtr){
+            usbMsgCrc = (usbMsgPtr_t)USB_READ_FLASH_WORD(&entry->crc);
+            usbMsgCrcLen = USB_READ_FLASH(&entry->len);
+            break;
+        }
+        entry++;
+    }
+}
+#endif
+
+#if USB_CFG_INTERFACE_COUNT > 1
+/* Pass class and vendor requests addressed to interface 1 or 2 to the
+ * handler of that interface. All other requests go to usbFunctionSetup()
+ * (or the request table).
+ */
+static inline usbMsgLen_t usbInterfaceSetup(uchar data[8])
+{
+usbRequest_t    *rq = (void *)data;
+
+    if((rq->bmRequestType & USBRQ_RCPT_MASK) == USBRQ_RCPT_INTERFACE){
+#if USB_CFG_HAVE_REQUEST_TABLE && (defined(USB_CFG_IFACE1_SETUP) || defined(USB_CFG_IFACE2_SETUP))
+        usbRequestUserStream(rq);   /* interface handlers may return USB_NO_MSG */
+#endif
+#ifdef USB_CFG_IFACE1_SETUP
+        if(rq->wIndex.bytes[0] == 1)
+            return USB_CFG_IFACE1_SETUP(data);
+#endif
+#ifdef USB_CFG_IFACE2_SETUP
+        if(rq->wIndex.bytes[0] == 2)
+            return USB_CFG_IFACE2_SETUP(data);
+#endif
+    }
+#if USB_CFG_HAVE_REQUEST_TABLE
+    return usbRequestSetup(rq);
+#else
+    return usbFunctionSetup(data);
+#endif
+}
+#endif
+
 /* usbProcessRx() is called for every message received by the interrupt
  * routine. It distinguishes between SETUP and DATA packets and processes
  * them accordingly.
@@ -448,16 +1306,25 @@ usbRequest_t    *rq = (void *)data;
         if(len != 8)    /* Setup size must be always 8 bytes. Ignore otherwise. */
             return;
         usbMsgLen_t replyLen;
-        usbTxBuf[0] = USBPID_DATA0;         /* initialize data toggling */
+        usbTxToken0 = USBPID_DATA0;         /* initialize data toggling */
         usbTxLen = USBPID_NAK;              /* abort pending transmit */
         usbMsgFlags = 0;
+#if USB_CFG_HAVE_FAR_FLASH_DATA
+        usbMsgPtrPage = USB_CFG_DRIVER_FLASH_PAGE;
+#endif
         uchar type = rq->bmRequestType & USBRQ_TYPE_MASK;
         if(type != USBRQ_TYPE_STANDARD){    /* standard requests are handled by driver */
+#if USB_CFG_INTERFACE_COUNT > 1
+            replyLen = usbInterfaceSetup(data);
+#elif USB_CFG_HAVE_REQUEST_TABLE
+            replyLen = usbRequestSetup(rq);
+#else
             replyLen = usbFunctionSetup(data);
+#endif
         }else{
             replyLen = usbDriverSetup(rq);
         }
-#if USB_CFG_IMPLEMENT_FN_READ || USB_CFG_IMPLEMENT_FN_WRITE
+#if USB_CFG_IMPLEMENT_FN_READ || USB_CFG_IMPLEMENT_FN_WRITE || USB_CFG_HAVE_REQUEST_TABLE
         if(replyLen == USB_NO_MSG){         /* use user-supplied read/write function */
             /* do some conditioning on replyLen, but on IN transfers only */
             if((rq->bmRequestType & USBRQ_DIR_MASK) != USBRQ_DIR_HOST_TO_DEVICE){
@@ -478,10 +1345,34 @@ usbRequest_t    *rq = (void *)data;
                 replyLen = rq->wLength.word;
         }
         usbMsgLen = replyLen;
+#if USB_CFG_HAVE_MSG_SEGMENTS
+        if(usbMsgFlags & USB_FLG_MSGPTR_IS_SEGMENTS){
+            usbMsgSegment = (usbMsgSegment_t *)usbMsgPtr;
+            usbSegmentLen = 0;
+        }
+#endif
+#if USB_HAVE_COMPRESSED_DESCRIPTOR
+        usbUnpackCount = 0;
+#endif
+#if USB_CFG_DESCR_CRC_TABLES
+#if USB_CFG_HAVE_FAR_FLASH_DATA
+        if((usbMsgFlags & USB_FLG_MSGPTR_IS_ROM) && usbMsgPtrPage == USB_CFG_DRIVER_FLASH_PAGE){
+#else
+        if(usbMsgFlags & USB_FLG_MSGPTR_IS_ROM){
+#endif
+            usbFindCrcTable();
+        }else{
+            usbMsgCrc = 0;
+        }
+#endif
     }else{  /* usbRxToken must be USBPID_OUT, which means data phase of setup (control-out) */
-#if USB_CFG_IMPLEMENT_FN_WRITE
+#if USB_CFG_IMPLEMENT_FN_WRITE || USB_CFG_HAVE_REQUEST_TABLE
         if(usbMsgFlags & USB_FLG_USE_USER_RW){
+#if USB_CFG_HAVE_REQUEST_TABLE
+            uchar rval = usbRqStream(data, len);
+#else
             uchar rval = usbFunctionWrite(data, len);
+#endif
             if(rval == 0xff){   /* an error occurred */
                 usbTxLen = USBPID_STALL;
             }else if(rval != 0){    /* This was the final package */
@@ -494,16 +1385,156 @@ usbRequest_t    *rq = (void *)data;
 
 /* ------------------------------------------------------------------------- */
 
+#if USB_CFG_HAVE_MSG_SEGMENTS
+/* Copy up to 'len' bytes of a segmented reply. usbMsgPtr and the ROM flag in
+ * usbMsgFlags describe the current segment.
+ */
+static uchar usbSegmentRead(uchar *data, uchar len)
+{
+uchar   count = 0;
+
+    while(count < len){
+        uchar i = usbSegmentLen;
+        if(i == 0){     /* advance to next segment */
+            usbMsgSegment_t *seg = usbMsgSegment;
+            i = seg->len;
+            if(i == 0)  /* end of list */
+                break;
+            usbMsgPtr = (usbMsgPtr_t)seg->ptr;
+            usbMsgFlags = USB_FLG_MSGPTR_IS_SEGMENTS | seg->flags;
+            usbMsgSegment = seg + 1;
+            usbSegmentLen = i;
+        }
+        if(i > (uchar)(len - count))
+            i = len - count;
+        usbSegmentLen -= i;
+        count += i;
+        usbMsgPtr_t r = usbMsgPtr;
+        if(usbMsgFlags & USB_FLG_MSGPTR_IS_ROM){
+            do{
+                uchar c = USB_READ_FLASH(r);
+                *data++ = c;
+                r++;
+            }while(--i);
+        }else{
+            do{
+                *data++ = *((uchar *)r);
+                r++;
+            }while(--i);
+        }
+        usbMsgPtr = r;
+    }
+    return count;
+}
+#endif
+
+#if USB_HAVE_COMPRESSED_DESCRIPTOR
+/* Unpack the next 'len' bytes of a compressed descriptor. usbMsgPtr points
+ * to the next token or literal byte in flash memory.
+ */
+static uchar usbUnpackRead(uchar *data, uchar len)
+{
+uchar   i = len;
+
+    do{
+        uchar token = usbUnpackToken;
+        uchar n = usbUnpackCount;
+        if(n == 0){     /* start next token */
+            usbMsgPtr_t r = usbMsgPtr;
+            token = USB_READ_FLASH(r);
+            r++;
+            n = (token & 0x3f) + 1;
+            if(token & 0x80){
+                uchar offset = USB_READ_FLASH(r);
+                usbUnpackSource = r - 2 - offset;
+                r++;
+                n = (token & 0x7f) + 3;
+            }else if(token & 0x40){
+                n += n; /* each character is followed by a 0 byte */
+            }
+            usbMsgPtr = r;
+            usbUnpackToken = token;
+        }
+        uchar c = 0;
+        if(token & 0x80){
+            usbMsgPtr_t r = usbUnpackSource;
+            c = USB_READ_FLASH(r);
+            usbUnpackSource = r + 1;
+        }else if(!(token & 0x40) || !(n & 1)){
+            usbMsgPtr_t r = usbMsgPtr;
+            c = USB_READ_FLASH(r);
+            usbMsgPtr = r + 1;
+        }
+        *data++ = c;
+        usbUnpackCount = n - 1;
+    }while(--i);
+    return len;
+}
+#endif
+
+#if USB_CFG_HAVE_FAR_FLASH_DATA
+/* Copy 'len' bytes of flash memory data at usbMsgPtr in page usbMsgPtrPage.
+ * The page is advanced when the data crosses a 64 kB boundary.
+ */
+static uchar usbFarFlashRead(uchar *data, uchar len)
+{
+uchar       i = len, page = usbMsgPtrPage;
+usbMsgPtr_t r = usbMsgPtr;
+
+    do{
+        uchar c = USB_READ_FLASH_FAR(page, r);
+        *data++ = c;
+        r++;
+        if((unsigned)r == 0)
+            page++;
+    }while(--i);
+    usbMsgPtr = r;
+    usbMsgPtrPage = page;
+    return len;
+}
+#endif
+
 /* This function is similar to usbFunctionRead(), but it's also called for
  * data handled automatically by the driver (e.g. descriptor reads).
  */
 static uchar usbDeviceRead(uchar *data, uchar len)
 {
     if(len > 0){    /* don't bother app with 0 sized reads */
-#if USB_CFG_IMPLEMENT_FN_READ
+#if USB_CFG_HAVE_REQUEST_TABLE
+        if(usbMsgFlags & USB_FLG_USE_USER_RW){
+            len = usbRqStream(data, len);
+        }else
+#elif USB_CFG_IMPLEMENT_FN_READ
         if(usbMsgFlags & USB_FLG_USE_USER_RW){
             len = usbFunctionRead(data, len);
         }else
+#endif
+#if USB_CFG_HAVE_MSG_SEGMENTS
+        if(usbMsgFlags & USB_FLG_MSGPTR_IS_SEGMENTS){
+            len = usbSegmentRead(data, len);
+        }else
+#endif
+#if USB_HAVE_COMPRESSED_DESCRIPTOR
+        if(usbMsgFlags & USB_FLG_MSGPTR_IS_COMPRESSED){
+            len = usbUnpackRead(data, len);
+        }else
+#endif
+#if USB_CFG_HAVE_FAR_FLASH_DATA
+        if(usbMsgFlags & USB_FLG_MSGPTR_IS_ROM){
+            len = usbFarFlashRead(data, len);
+        }else
+#endif
+#if USB_HAVE_EEPROM_DATA
+        if(usbMsgFlags & USB_FLG_MSGPTR_IS_EEPROM){
+            uchar i = len;
+            usbMsgPtr_t r = usbMsgPtr;
+            do{
+                uchar c = USB_READ_EEPROM(r);
+                *data++ = c;
+                r++;
+            }while(--i);
+            usbMsgPtr = r;
+        }else
 #endif
         {
             uchar i = len;
@@ -540,9 +1571,27 @@ uchar       len;
     if(wantLen > 8)
         wantLen = 8;
     usbMsgLen -= wantLen;
-    usbTxBuf[0] ^= USBPID_DATA0 ^ USBPID_DATA1; /* DATA toggling */
+    usbTxToken0 ^= USBPID_DATA0 ^ USBPID_DATA1; /* DATA toggling */
+#if USB_CFG_SHARED_TX_BUFFER
+    usbTxBuf[0] = usbTxToken0;
+#endif
     len = usbDeviceRead(usbTxBuf + 1, wantLen);
     if(len <= 8){           /* valid data packet */
+#if USB_CFG_DESCR_CRC_TABLES
+        /* Packets start at multiples of 8 in the descriptor. The table applies
+         * to full packets and to the last packet of the whole descriptor, but
+         * not to a short packet at the end of a truncated reply.
+         */
+        if(usbMsgCrc != 0 && len != 0 && (len == 8 || len == usbMsgCrcLen)){
+            usbMsgPtr_t r = usbMsgCrc;
+            uchar c = USB_READ_FLASH(r);
+            usbTxBuf[len + 1] = c;
+            c = USB_READ_FLASH(r + 1);
+            usbTxBuf[len + 2] = c;
+            usbMsgCrc = r + 2;
+            usbMsgCrcLen -= len;
+        }else
+#endif
         usbCrc16Append(&usbTxBuf[1], len);
         len += 4;           /* length including sync byte */
         if(len < 12)        /* a partial package identifies end of message */
@@ -632,17 +1681,31 @@ uchar   i;
 
     len = usbRxLen - 3;
     if(len >= 0){
-/* We could check CRC16 here -- but ACK has already been sent anyway. If you
- * need data integrity checks with this driver, check the CRC in your app
- * code and report errors back to the host. Since the ACK was already sent,
- * retries must be handled on application level.
- * unsigned crc = usbCrc16(buffer + 1, usbRxLen - 3);
- */
 #ifdef USB_CFG_USE_INTERRUPT_FREE_IMPL
-        usbProcessRx(usbRxBuf + 1, len); // only single buffer due to in-order processing
+        uchar *data = usbRxBuf + 1; // only single buffer due to in-order processing
 #else
-        usbProcessRx(usbRxBuf + USB_BUFSIZE + 1 - usbInputBufOffset, len);
+        uchar *data = usbRxBuf + USB_BUFSIZE + 1 - usbInputBufOffset;
 #endif
+/* The ACK has already been sent when we get here. With
+ * USB_CFG_STALL_ON_CRC_ERROR we check the CRC16 of control transfers anyway
+ * and abort the transfer if it fails, so that the host sees STALL instead
+ * of a success. Packets for other endpoints are not checked: they can only
+ * be dropped, which would lose them silently.
+ */
+#if USB_CHECK_CRC_IN_POLL
+        if(usbRxToken >= 0x10 && usbCrc16(data, len) != (data[len] | (data[len + 1] << 8))){
+            DBG1(0xfe, &usbRxToken, 1);   /* CRC error in SETUP or control-out */
+            usbMsgLen = USB_NO_MSG;     /* abort transfer */
+            usbMsgFlags = 0;            /* no more calls to usbFunctionWrite() */
+            usbTxLen = USBPID_STALL;    /* host sees STALL in status stage */
+        }else
+#endif
+#if USB_CFG_FILTER_DATA_TOGGLING
+        if(usbIsDuplicate()){
+            DBG1(0xfd, &usbRxToken, 1);   /* duplicate packet */
+        }else
+#endif
+        usbProcessRx(data, len);
 #if USB_CFG_HAVE_FLOWCONTROL
         if(usbRxLen > 0)    /* only mark as available if not inactivated */
             usbRxLen = 0;
@@ -650,7 +1713,13 @@ uchar   i;
         usbRxLen = 0;       /* mark rx buffer as available */
 #endif
     }
+#if USB_CFG_SHARED_TX_BUFFER
+    if(usbMsgLen != USB_NO_MSG && (usbTxLen & 0x10))
+        usbDropIntrPackets();   /* the control reply needs the buffer */
+    if(usbTxBufIsFree()){   /* transmit system idle, no interrupt data pending */
+#else
     if(usbTxLen & 0x10){    /* transmit system idle */
+#endif
         if(usbMsgLen != USB_NO_MSG){    /* transmit data pending? */
             usbBuildTxBlock();
         }
@@ -665,6 +1734,13 @@ uchar   i;
     usbNewDeviceAddr = 0;
     usbDeviceAddr = 0;
     usbResetStall();
+#if USB_CFG_SHARED_TX_BUFFER
+    usbConfiguration = 0;   /* usbInterruptIsReady() waits for configuration */
+    usbDropIntrPackets();
+#endif
+#if USB_CFG_DESCR_CACHE_SIZE
+    usbFlushDescrCache();
+#endif
     DBG1(0xff, 0, 0);
 isNotReset:
     usbHandleResetHook(i);
@@ -673,8 +1749,48 @@ isNotReset:
 
 /* ------------------------------------------------------------------------- */
 
+#if USB_CFG_CLOCK2_KHZ && USB_CFG_HAVE_MEASURE_FRAME_LENGTH
+
+/* usbMeasureFrameLength() returns 1499 * F_CPU / 10.5 MHz */
+#define USB_FRAME_LENGTH(khz)   ((unsigned)((khz) * 1499UL / 10500))
+
+static unsigned usbFrameDistance(unsigned len, unsigned khz)
+{
+unsigned    expected = USB_FRAME_LENGTH(khz);
+
+    return len > expected ? len - expected : expected - len;
+}
+
+USB_PUBLIC uchar usbSelectClock(void)
+{
+unsigned    len = usbMeasureFrameLength();
+uchar       index = 0;
+
+    if(len == 0)    /* timeout, no frame seen */
+        return 0;
+    if(usbFrameDistance(len, USB_CFG_CLOCK2_KHZ) < usbFrameDistance(len, USB_CFG_CLOCK_KHZ))
+        index = 1;
+#if USB_CFG_CLOCK3_KHZ
+    if(usbFrameDistance(len, USB_CFG_CLOCK3_KHZ) < usbFrameDistance(len, index ? USB_CFG_CLOCK2_KHZ : USB_CFG_CLOCK_KHZ))
+        index = 2;
+#endif
+    usbClockIndex = index;
+    return 1;
+}
+
+#endif
+
+/* ------------------------------------------------------------------------- */
+
 USB_PUBLIC void usbInit(void)
 {
+#if USB_CFG_FIXED_REGISTERS     /* not initialized by the C startup code */
+    usbInputBufOffset = 0;
+    usbDeviceAddr = 0;
+    usbRxLen = 0;
+    usbCurrentTok = 0;
+    usbTxLen = USBPID_NAK;
+#endif
 #if USB_INTR_CFG_SET != 0
     USB_INTR_CFG |= USB_INTR_CFG_SET;
 #endif
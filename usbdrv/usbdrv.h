@@ -102,6 +102,8 @@ interrupt routine.
 Interrupt latency:
 The application must ensure that the USB interrupt is not disabled for more
 than 25 cycles (this is for 12 MHz, faster clocks allow longer latency).
+With USB_CFG_CLOCK2_KHZ, subtract the cycles of the clock dispatch (see
+usbdrvasm.S).
 This implies that all interrupt routines must either have the "ISR_NOBLOCK"
 attribute set (see "avr/interrupt.h") or be written in assembler with "sei"
 as the first instruction.
@@ -155,6 +157,21 @@ extern "C" {
  * directly in your code saves a couple of bytes in flash memory.
  */
 
+#if USB_CFG_FIXED_REGISTERS
+#define USB_REG_SREG                2
+#define USB_REG_RX_LEN              3
+#define USB_REG_TX_LEN              4
+#define USB_REG_CURRENT_TOK         5
+#define USB_REG_INPUT_BUF_OFFSET    6
+#define USB_REG_DEVICE_ADDR         7
+#endif
+/* Register numbers used with USB_CFG_FIXED_REGISTERS: The interrupt routine
+ * saves SREG in r2 instead of on the stack and the driver keeps usbRxLen,
+ * usbTxLen, usbCurrentTok, usbInputBufOffset and usbDeviceAddr in r3 to r7.
+ * All modules must be compiled with
+ * -ffixed-r2 -ffixed-r3 -ffixed-r4 -ffixed-r5 -ffixed-r6 -ffixed-r7.
+ */
+
 #ifndef __ASSEMBLER__
 #ifndef uchar
 #define uchar   unsigned char
@@ -216,6 +233,67 @@ extern uchar usbMsgFlags;    /* flag values see USB_FLG_* */
  */
 
 #define USB_FLG_MSGPTR_IS_ROM   (1<<6)
+#define USB_FLG_MSGPTR_IS_EEPROM    (1<<3)
+/* Set usbMsgFlags to this value if usbMsgPtr has been set to an EEPROM
+ * address. The data is read from EEPROM while it is sent. This requires
+ * USB_CFG_HAVE_EEPROM_DATA in usbconfig.h unless a descriptor has the
+ * property USB_PROP_IS_EEPROM.
+ */
+
+#if USB_CFG_HAVE_FAR_FLASH_DATA
+#ifndef USB_CFG_DRIVER_FLASH_PAGE
+#define USB_CFG_DRIVER_FLASH_PAGE   0
+#endif
+extern uchar usbMsgPtrPage;
+/* The 64 kB page of flash memory data returned in usbMsgPtr with
+ * USB_FLG_MSGPTR_IS_ROM. The driver sets it to USB_CFG_DRIVER_FLASH_PAGE
+ * before usbFunctionSetup() is called, so only replies in other pages must
+ * set it. Replies may cross page boundaries. Example for avr-libc:
+ *
+ *     uint_farptr_t   addr = pgm_get_far_address(table);
+ *     usbMsgPtr = (usbMsgPtr_t)(unsigned)addr;
+ *     usbMsgPtrPage = addr >> 16;
+ *     usbMsgFlags = USB_FLG_MSGPTR_IS_ROM;
+ *
+ * Segments, compressed descriptors and CRC tables are always read from
+ * USB_CFG_DRIVER_FLASH_PAGE.
+ */
+#endif
+
+#if USB_CFG_HAVE_MSG_SEGMENTS
+#define USB_FLG_MSGPTR_IS_SEGMENTS  (1<<5)
+/* Set usbMsgFlags to this value in usbFunctionSetup() if usbMsgPtr has been
+ * set to a list of segments (see below) instead of the reply data.
+ */
+
+typedef struct usbMsgSegment{
+    const void  *ptr;   /* data of this segment */
+    uchar       len;    /* length of this segment, 0 terminates the list */
+    uchar       flags;  /* USB_FLG_MSGPTR_IS_ROM or 0 for RAM data */
+}usbMsgSegment_t;
+
+#define USB_MSG_SEGMENT_RAM(ptr, len)   {(const void *)(ptr), len, 0}
+#define USB_MSG_SEGMENT_ROM(ptr, len)   {(const void *)(ptr), len, USB_FLG_MSGPTR_IS_ROM}
+#define USB_MSG_SEGMENT_END             {(const void *)0, 0, 0}
+/* A control-in reply may consist of several segments in RAM and flash
+ * memory, e.g. a status header in RAM followed by a table in flash memory.
+ * The driver reads the segments in order and packs them into packets of 8
+ * bytes, so the reply doesn't have to be assembled in a RAM buffer. Example:
+ *
+ *     static usbMsgSegment_t  segments[] = {
+ *         USB_MSG_SEGMENT_RAM(&status, sizeof(status)),
+ *         USB_MSG_SEGMENT_ROM(table, sizeof(table)),
+ *         USB_MSG_SEGMENT_END
+ *     };
+ *     ...
+ *     usbMsgPtr = (usbMsgPtr_t)segments;
+ *     usbMsgFlags = USB_FLG_MSGPTR_IS_SEGMENTS;
+ *     return sizeof(status) + sizeof(table);
+ *
+ * The list itself must be in RAM and must stay valid until the transfer
+ * ends. If the list holds fewer bytes than returned, the reply is shorter.
+ */
+#endif
 
 USB_PUBLIC usbMsgLen_t usbFunctionSetup(uchar data[8]);
 /* This function is called when the driver receives a SETUP transaction from
@@ -244,6 +322,18 @@ USB_PUBLIC usbMsgLen_t usbFunctionSetup(uchar data[8]);
  * Note that calls to the functions usbFunctionRead() and usbFunctionWrite()
  * are only done if enabled by the configuration in usbconfig.h.
  */
+#ifdef USB_CFG_IFACE1_SETUP
+USB_PUBLIC usbMsgLen_t USB_CFG_IFACE1_SETUP(uchar data[8]);
+#endif
+#ifdef USB_CFG_IFACE2_SETUP
+USB_PUBLIC usbMsgLen_t USB_CFG_IFACE2_SETUP(uchar data[8]);
+#endif
+/* In composite devices (USB_CFG_INTERFACE_COUNT > 1), class and vendor
+ * requests addressed to interface 1 or 2 are passed to the functions named
+ * by USB_CFG_IFACE1_SETUP and USB_CFG_IFACE2_SETUP instead of
+ * usbFunctionSetup(). They work exactly like usbFunctionSetup() and share
+ * usbFunctionRead() and usbFunctionWrite() with it.
+ */
 USB_PUBLIC usbMsgLen_t usbFunctionDescriptor(struct usbRequest *rq);
 /* You need to implement this function ONLY if you provide USB descriptors at
  * runtime (which is an expert feature). It is very similar to
@@ -258,14 +348,33 @@ USB_PUBLIC void usbSetInterrupt(uchar *data, uchar len);
  * interrupt status to the host.
  * If you need to transfer more bytes, use a control read after the interrupt.
  */
+#if USB_CFG_SHARED_TX_BUFFER
+#define usbInterruptIsReady()   (usbConfiguration != 0 && usbTxBufIsFree())
+#else
 #define usbInterruptIsReady()   (usbTxLen1 & 0x10)
+#endif
 /* This macro indicates whether the last interrupt message has already been
  * sent. If you set a new interrupt message before the old was sent, the
- * message already buffered will be lost.
+ * message already buffered will be lost. With USB_CFG_SHARED_TX_BUFFER, it
+ * also waits for packets of the other endpoints and for the host to configure
+ * the device, and usbSetInterrupt() drops the message if it is called while
+ * it would return false.
+ */
+#if USB_CFG_SHARED_TX_BUFFER
+extern uchar    usbIntrDropped;
+/* With USB_CFG_SHARED_TX_BUFFER, usbPoll() drops a pending interrupt packet
+ * when a control transfer needs the buffer for its reply or on bus reset. It
+ * then sets bit 1 (endpoint 1) or bit 3 (endpoint 3) in this variable. Clear
+ * the bit when you have sent the data again.
  */
+#endif
 #if USB_CFG_HAVE_INTRIN_ENDPOINT3
 USB_PUBLIC void usbSetInterrupt3(uchar *data, uchar len);
+#if USB_CFG_SHARED_TX_BUFFER
+#define usbInterruptIsReady3()  (usbConfiguration != 0 && usbTxBufIsFree())
+#else
 #define usbInterruptIsReady3()   (usbTxLen3 & 0x10)
+#endif
 /* Same as above for endpoint 3 */
 #endif
 #endif /* USB_CFG_HAVE_INTRIN_ENDPOINT */
@@ -364,6 +473,22 @@ extern unsigned usbMeasureFrameLength(void);
  * This can be used to calibrate the AVR's RC oscillator.
  */
 #endif
+#if USB_CFG_CLOCK2_KHZ
+extern uchar    usbClockIndex;
+/* This variable selects the receiver used by the interrupt: 0 for
+ * USB_CFG_CLOCK_KHZ, 1 for USB_CFG_CLOCK2_KHZ and 2 for USB_CFG_CLOCK3_KHZ.
+ * It defaults to 0. Set it before you enable interrupts with sei().
+ */
+#if USB_CFG_HAVE_MEASURE_FRAME_LENGTH
+USB_PUBLIC uchar usbSelectClock(void);
+/* This function measures the CPU clock against the 1 ms frame clock of the
+ * host with usbMeasureFrameLength() and sets usbClockIndex to the nearest
+ * configured clock rate. It returns 0 and leaves usbClockIndex unchanged if
+ * no frame was seen. The same restrictions as for usbMeasureFrameLength()
+ * apply: call it with interrupts disabled after usbDeviceConnect().
+ */
+#endif
+#endif
 extern uchar    usbConfiguration;
 /* This value contains the current configuration set by the host. The driver
  * allows setting and querying of this variable with the USB SET_CONFIGURATION
@@ -377,19 +502,30 @@ extern volatile uchar   usbSofCount;
  * the macro USB_COUNT_SOF is defined to a value != 0.
  */
 #endif
-#if USB_CFG_CHECK_DATA_TOGGLING
+#if USB_CFG_CHECK_DATA_TOGGLING || USB_CFG_FILTER_DATA_TOGGLING
 extern uchar    usbCurrentDataToken;
 /* This variable can be checked in usbFunctionWrite() and usbFunctionWriteOut()
  * to ignore duplicate packets.
  */
 #endif
+#if USB_CFG_FIXED_REGISTERS
+#define USB_REG_NAME_(n)    "r" #n
+#define USB_REG_NAME(n)     USB_REG_NAME_(n)
+register schar  usbRxLen asm(USB_REG_NAME(USB_REG_RX_LEN));
+register uchar  usbTxLen asm(USB_REG_NAME(USB_REG_TX_LEN));
+/* Global register variables are not volatile: Don't wait for a change of
+ * these variables in a loop which does not call a function.
+ */
+#endif
 
 #define USB_STRING_DESCRIPTOR_HEADER(stringLength) ((2*(stringLength)+2) | (3<<8))
 /* This macro builds a descriptor header for a string descriptor given the
  * string's length. See usbdrv.c for an example how to use it.
  */
 #if USB_CFG_HAVE_FLOWCONTROL
+#if !USB_CFG_FIXED_REGISTERS
 extern volatile schar   usbRxLen;
+#endif
 #define usbDisableAllRequests()     usbRxLen = -1
 /* Must be called from usbFunctionWrite(). This macro disables all data input
  * from the USB interface. Requests from the host are answered with a NAK
@@ -406,8 +542,13 @@ extern volatile schar   usbRxLen;
  */
 #endif
 
+#if USB_CFG_SHARED_TX_BUFFER
+#define USB_SET_DATATOKEN1(token)   usbTxStatus1.dataToken = token
+#define USB_SET_DATATOKEN3(token)   usbTxStatus3.dataToken = token
+#else
 #define USB_SET_DATATOKEN1(token)   usbTxBuf1[0] = token
 #define USB_SET_DATATOKEN3(token)   usbTxBuf3[0] = token
+#endif
 /* These two macros can be used by application software to reset data toggling
  * for interrupt-in endpoints 1 and 3. Since the token is toggled BEFORE
  * sending data, you must set the opposite value of the token which should come
@@ -428,17 +569,35 @@ extern volatile schar   usbRxLen;
 /* If this property is set for a descriptor, usbFunctionDescriptor() will be
  * used to obtain the particular descriptor. Data directly returned via
  * usbMsgPtr are FLASH data by default, combine (OR) with USB_PROP_IS_RAM to
- * return RAM data.
+ * return RAM data or with USB_PROP_IS_EEPROM to return EEPROM data.
  */
 #define USB_PROP_IS_RAM         (1u << 15)
 /* If this property is set for a descriptor, the data is read from RAM
  * memory instead of Flash. The property is used for all methods to provide
  * external descriptors.
  */
-#define USB_PROP_LENGTH(len)    ((len) & 0x3fff)
+#define USB_PROP_IS_COMPRESSED  (1u << 13)
+/* If this property is set for a static descriptor in flash memory, the data
+ * is stored in the compressed format described in usbdrv.c and unpacked
+ * while it is sent. USB_PROP_LENGTH() is the length after unpacking. Use
+ * tools/usbdescgen with option -z to generate compressed descriptors.
+ * Compressed descriptors are declared as char arrays, even strings.
+ */
+#define USB_PROP_IS_EEPROM      (1u << 12)
+/* If this property is set for a descriptor, the data is read from EEPROM
+ * while it is sent instead of Flash. This is useful for serial numbers and
+ * other per-unit data. Static descriptors with this property must be
+ * defined with EEMEM (or __eeprom with IAR).
+ */
+#define USB_PROP_LENGTH(len)    (((len) & 0x0fff) | ((len) > 0x0fff ? USB_PROP_LENGTH_OVERFLOW : 0))
 /* If a static external descriptor is used, this is the total length of the
- * descriptor in bytes.
+ * descriptor in bytes. The length is limited to 4095 bytes (0x0fff) because
+ * the upper bits hold the properties above. usbdrv.c rejects longer lengths
+ * at compile time. Use USB_PROP_LENGTH_OF() to extract the length from a
+ * property value.
  */
+#define USB_PROP_LENGTH_OVERFLOW    0x10000L    /* not a property, only seen by the check in usbdrv.c */
+#define USB_PROP_LENGTH_OF(props)   ((props) & 0x0fff)
 
 /* all descriptors which may have properties: */
 #ifndef USB_CFG_DESCR_PROPS_DEVICE
@@ -483,46 +642,91 @@ extern volatile schar   usbRxLen;
  */
 #ifndef __ASSEMBLER__
 extern
-#if !(USB_CFG_DESCR_PROPS_DEVICE & USB_PROP_IS_RAM)
+#if !(USB_CFG_DESCR_PROPS_DEVICE & (USB_PROP_IS_RAM | USB_PROP_IS_EEPROM))
 PROGMEM const
 #endif
 char usbDescriptorDevice[];
 
 extern
-#if !(USB_CFG_DESCR_PROPS_CONFIGURATION & USB_PROP_IS_RAM)
+#if !(USB_CFG_DESCR_PROPS_CONFIGURATION & (USB_PROP_IS_RAM | USB_PROP_IS_EEPROM))
 PROGMEM const
 #endif
 char usbDescriptorConfiguration[];
 
 extern
-#if !(USB_CFG_DESCR_PROPS_HID_REPORT & USB_PROP_IS_RAM)
+#if !(USB_CFG_DESCR_PROPS_HID_REPORT & (USB_PROP_IS_RAM | USB_PROP_IS_EEPROM))
 PROGMEM const
 #endif
 char usbDescriptorHidReport[];
 
+#if USB_CFG_INTERFACE_COUNT > 1
+extern PROGMEM const char usbDescriptorHidReport1[];
+extern PROGMEM const char usbDescriptorHidReport2[];
+/* report descriptors of interfaces 1 and 2 if they are HID interfaces */
+#endif
+
 extern
-#if !(USB_CFG_DESCR_PROPS_STRING_0 & USB_PROP_IS_RAM)
+#if !(USB_CFG_DESCR_PROPS_STRING_0 & (USB_PROP_IS_RAM | USB_PROP_IS_EEPROM))
 PROGMEM const
 #endif
 char usbDescriptorString0[];
 
 extern
-#if !(USB_CFG_DESCR_PROPS_STRING_VENDOR & USB_PROP_IS_RAM)
+#if !(USB_CFG_DESCR_PROPS_STRING_VENDOR & (USB_PROP_IS_RAM | USB_PROP_IS_EEPROM))
 PROGMEM const
 #endif
-int usbDescriptorStringVendor[];
+#if USB_CFG_DESCR_PROPS_STRING_VENDOR & USB_PROP_IS_COMPRESSED
+char
+#else
+int
+#endif
+usbDescriptorStringVendor[];
 
 extern
-#if !(USB_CFG_DESCR_PROPS_STRING_PRODUCT & USB_PROP_IS_RAM)
+#if !(USB_CFG_DESCR_PROPS_STRING_PRODUCT & (USB_PROP_IS_RAM | USB_PROP_IS_EEPROM))
 PROGMEM const
 #endif
-int usbDescriptorStringDevice[];
+#if USB_CFG_DESCR_PROPS_STRING_PRODUCT & USB_PROP_IS_COMPRESSED
+char
+#else
+int
+#endif
+usbDescriptorStringDevice[];
 
 extern
-#if !(USB_CFG_DESCR_PROPS_STRING_SERIAL_NUMBER & USB_PROP_IS_RAM)
+#if !(USB_CFG_DESCR_PROPS_STRING_SERIAL_NUMBER & (USB_PROP_IS_RAM | USB_PROP_IS_EEPROM))
 PROGMEM const
 #endif
-int usbDescriptorStringSerialNumber[];
+#if USB_CFG_DESCR_PROPS_STRING_SERIAL_NUMBER & USB_PROP_IS_COMPRESSED
+char
+#else
+int
+#endif
+usbDescriptorStringSerialNumber[];
+
+#if USB_CFG_STRING_COUNT && USB_CFG_LANGUAGE_COUNT > 1
+extern PROGMEM const int *const usbStringTableLanguages[USB_CFG_LANGUAGE_COUNT - 1][USB_CFG_STRING_COUNT];
+/* String descriptors for the second and further languages in
+ * USB_CFG_LANGUAGE_IDS, provided by the application. NULL entries fall back
+ * to the string of the first language. See usbconfig-prototype.h.
+ */
+#endif
+
+#if USB_CFG_DESCR_CRC_TABLES
+typedef struct usbDescrCrcEntry{
+    const void  *descriptor;    /* descriptor in flash memory */
+    const uchar *crc;           /* CRC of each 8 byte packet, low byte first */
+    uchar       len;            /* length of descriptor */
+}usbDescrCrcEntry_t;
+
+extern PROGMEM const usbDescrCrcEntry_t usbDescrCrcTable[];
+extern PROGMEM const uchar usbDescrCrcTableSize;
+/* Precomputed packet CRCs of static descriptors, generated by
+ * tools/usbdescgen. When a reply starts at one of these descriptors, the
+ * driver copies the CRC of each packet from the table instead of computing
+ * it with usbCrc16Append().
+ */
+#endif
 
 #endif /* __ASSEMBLER__ */
 
@@ -596,6 +800,53 @@ int usbDescriptorStringSerialNumber[];
 #define USB_CFG_HAVE_INTRIN_ENDPOINT3   0
 #endif
 
+#if USB_CFG_SHARED_TX_BUFFER && (!USB_CFG_HAVE_INTRIN_ENDPOINT || USB_CFG_SUPPRESS_INTR_CODE)
+#undef USB_CFG_SHARED_TX_BUFFER     /* no interrupt endpoint to share the buffer with */
+#define USB_CFG_SHARED_TX_BUFFER    0
+#endif
+
+/* the 18 MHz CRC receiver drops corrupted packets in the interrupt already */
+#define USB_CHECK_CRC_IN_POLL   (USB_CFG_STALL_ON_CRC_ERROR && !USB_CFG_CHECK_CRC)
+
+#ifndef USB_CFG_CONFIGURATION_STRING    /* string indices in default configuration descriptor */
+#define USB_CFG_CONFIGURATION_STRING    0
+#endif
+#ifndef USB_CFG_INTERFACE_STRING
+#define USB_CFG_INTERFACE_STRING        0
+#endif
+
+#ifndef USB_CFG_INTERFACE_COUNT
+#define USB_CFG_INTERFACE_COUNT         1
+#endif
+#if USB_CFG_INTERFACE_COUNT > 1     /* defaults for interfaces of composite devices */
+#   ifndef USB_CFG_IFACE1_SUBCLASS
+#       define USB_CFG_IFACE1_SUBCLASS          0
+#   endif
+#   ifndef USB_CFG_IFACE1_PROTOCOL
+#       define USB_CFG_IFACE1_PROTOCOL          0
+#   endif
+#   ifndef USB_CFG_IFACE1_ENDPOINT
+#       define USB_CFG_IFACE1_ENDPOINT          0
+#   endif
+#   ifndef USB_CFG_IFACE1_HID_REPORT_LENGTH
+#       define USB_CFG_IFACE1_HID_REPORT_LENGTH 0
+#   endif
+#endif
+#if USB_CFG_INTERFACE_COUNT > 2
+#   ifndef USB_CFG_IFACE2_SUBCLASS
+#       define USB_CFG_IFACE2_SUBCLASS          0
+#   endif
+#   ifndef USB_CFG_IFACE2_PROTOCOL
+#       define USB_CFG_IFACE2_PROTOCOL          0
+#   endif
+#   ifndef USB_CFG_IFACE2_ENDPOINT
+#       define USB_CFG_IFACE2_ENDPOINT          0
+#   endif
+#   ifndef USB_CFG_IFACE2_HID_REPORT_LENGTH
+#       define USB_CFG_IFACE2_HID_REPORT_LENGTH 0
+#   endif
+#endif
+
 #define USB_BUFSIZE     11  /* PID, 8 bytes data, 2 bytes CRC */
 
 /* ----- Try to find registers and bits responsible for ext interrupt 0 ----- */
@@ -678,6 +929,30 @@ at90s1200, attiny11, attiny12, attiny15, attiny28: these have no RAM
 
 #ifndef __ASSEMBLER__
 
+#if USB_CFG_SHARED_TX_BUFFER
+typedef struct usbTxStatus{
+    volatile uchar   len;
+    uchar   dataToken;  /* the packet itself is built in usbTxBuf */
+}usbTxStatus_t;
+
+#if !USB_CFG_FIXED_REGISTERS
+extern volatile uchar   usbTxLen;
+#endif
+extern uchar            usbTxBuf[USB_BUFSIZE];
+extern usbTxStatus_t    usbTxStatus1, usbTxStatus3;
+#define usbTxLen1   usbTxStatus1.len
+#define usbTxBuf1   usbTxBuf
+#define usbTxLen3   usbTxStatus3.len
+#define usbTxBuf3   usbTxBuf
+#if USB_CFG_HAVE_INTRIN_ENDPOINT3
+#   define usbTxBufIsFree() (usbTxLen & usbTxLen1 & usbTxLen3 & 0x10)
+#else
+#   define usbTxBufIsFree() (usbTxLen & usbTxLen1 & 0x10)
+#endif
+/* All endpoints send from usbTxBuf. A packet can be prepared when no
+ * endpoint has a packet pending, i.e. all lengths are handshake tokens.
+ */
+#else
 typedef struct usbTxStatus{
     volatile uchar   len;
     uchar   buffer[USB_BUFSIZE];
@@ -688,6 +963,7 @@ extern usbTxStatus_t   usbTxStatus1, usbTxStatus3;
 #define usbTxBuf1   usbTxStatus1.buffer
 #define usbTxLen3   usbTxStatus3.len
 #define usbTxBuf3   usbTxStatus3.buffer
+#endif
 
 
 typedef union usbWord{
@@ -703,6 +979,69 @@ typedef struct usbRequest{
     usbWord_t   wLength;
 }usbRequest_t;
 /* This structure matches the 8 byte setup request */
+
+#if USB_CFG_HAVE_REQUEST_TABLE
+typedef usbMsgLen_t (*usbRequestHandler_t)(usbRequest_t *rq);
+typedef uchar       (*usbRequestStream_t)(uchar *data, uchar len);
+
+typedef struct usbRequestEntry{
+    uchar       bmRequestType;  /* direction bit is ignored */
+    uchar       bRequest;
+    uchar       kind;           /* USB_RQKIND_* */
+    uchar       len;            /* buffer size for USB_RQKIND_RAM and USB_RQKIND_ROM */
+    const void  *ptr;           /* handler, stream function or buffer */
+}usbRequestEntry_t;
+
+#define USB_RQKIND_HANDLER  0
+#define USB_RQKIND_RAM      1
+#define USB_RQKIND_ROM      2
+#define USB_RQKIND_STREAM   3
+
+#define USB_REQUEST_HANDLER(type, request, fn)      \
+    {(type) & ~USBRQ_DIR_MASK, request, USB_RQKIND_HANDLER, 0, (const void *)(usbRequestHandler_t)(fn)}
+#define USB_REQUEST_RAM(type, request, buffer, len) \
+    {(type) & ~USBRQ_DIR_MASK, request, USB_RQKIND_RAM, len, (const void *)(buffer)}
+#define USB_REQUEST_ROM(type, request, buffer, len) \
+    {(type) & ~USBRQ_DIR_MASK, request, USB_RQKIND_ROM, len, (const void *)(buffer)}
+#define USB_REQUEST_STREAM(type, request, fn)       \
+    {(type) & ~USBRQ_DIR_MASK, request, USB_RQKIND_STREAM, 0, (const void *)(usbRequestStream_t)(fn)}
+/* These macros build the entries of the request table, which replaces (or
+ * precedes, see USB_CFG_HAVE_REQUEST_TABLE in usbconfig-prototype.h) the
+ * usbFunctionSetup() function. The table must be defined in your code as
+ *
+ *     PROGMEM const usbRequestEntry_t usbRequestTable[] = {
+ *         USB_REQUEST_HANDLER(USBRQ_TYPE_VENDOR, CUSTOM_RQ_RESET, resetHandler),
+ *         USB_REQUEST_RAM(USBRQ_TYPE_VENDOR, CUSTOM_RQ_CONFIG, config, sizeof(config)),
+ *     };
+ *     PROGMEM const uchar usbRequestTableSize = sizeof(usbRequestTable) / sizeof(usbRequestTable[0]);
+ *
+ * The driver looks up class and vendor requests with a binary search. The
+ * entries must therefore be sorted in ascending order of 'type' (bmRequestType
+ * without the direction bit, i.e. type and recipient) and, for equal types,
+ * of 'request'. The direction of the transfer is taken from the request
+ * received, so one entry serves both directions. The kinds of entries are:
+ *
+ * USB_REQUEST_HANDLER: 'fn' is called like usbFunctionSetup(), but with
+ * a pointer to the request structure. It may set usbMsgPtr and usbMsgFlags
+ * and return a length. It may return USB_NO_MSG if USB_CFG_IMPLEMENT_FN_READ
+ * or USB_CFG_IMPLEMENT_FN_WRITE is set, usbFunctionRead() or
+ * usbFunctionWrite() is then called for the data phase.
+ * USB_REQUEST_RAM: control-in transfers send up to 'len' bytes from 'buffer'
+ * in RAM, control-out transfers store up to 'len' bytes in 'buffer'. Excess
+ * data from the host is discarded.
+ * USB_REQUEST_ROM: control-in transfers send up to 'len' bytes from 'buffer'
+ * in flash memory. Control-out transfers are accepted and the data ignored.
+ * USB_REQUEST_STREAM: 'fn' has the same semantics as usbFunctionRead() for
+ * control-in and usbFunctionWrite() for control-out transfers and is called
+ * for the data phase of this request. This does not require
+ * USB_CFG_IMPLEMENT_FN_READ or USB_CFG_IMPLEMENT_FN_WRITE.
+ *
+ * 'len' must not exceed 254. Requests not found in the table are answered
+ * with an empty reply, or passed to usbFunctionSetup() in fallback mode.
+ */
+extern PROGMEM const usbRequestEntry_t  usbRequestTable[];
+extern PROGMEM const uchar              usbRequestTableSize;
+#endif  /* USB_CFG_HAVE_REQUEST_TABLE */
 #endif
 
 /* bmRequestType field in USB setup:
@@ -52,6 +52,10 @@ Thanks to Oleg Semyonov for his help with the IAR tools port!
 #endif
 
 #define USB_READ_FLASH(addr)    (*(PROGMEM char *)(addr))
+#define USB_READ_EEPROM(addr)   (*(__eeprom char *)(addr))
+#ifdef __HAS_ELPM__
+#   define USB_READ_FLASH_FAR(page, addr)   (*(__farflash char *)(((long)(page) << 16) | (unsigned)(addr)))
+#endif
 
 /* The following definitions are not needed by the driver, but may be of some
  * help if you port a gcc based project to IAR.
@@ -94,6 +98,7 @@ Thanks to Oleg Semyonov for his help with the IAR tools port!
 
 #define PROGMEM                 __flash
 #define USB_READ_FLASH(addr)    (*(PROGMEM char *)(addr))
+#define USB_READ_EEPROM(addr)   (*(eeprom char *)(addr))
 
 #ifndef __ASSEMBLER__
 static inline void  cli(void)
@@ -122,6 +127,7 @@ static inline void  sei(void)
 #   define _VECTOR(N)   __vector_ ## N   /* io.h does not define this for asm */
 #else
 #   include <avr/pgmspace.h>
+#   include <avr/eeprom.h>
 #endif
 
 #if USB_CFG_DRIVER_FLASH_PAGE
@@ -129,6 +135,10 @@ static inline void  sei(void)
 #else
 #   define USB_READ_FLASH(addr)    pgm_read_byte(addr)
 #endif
+#define USB_READ_EEPROM(addr)   eeprom_read_byte((const uint8_t *)(addr))
+#ifdef RAMPZ
+#   define USB_READ_FLASH_FAR(page, addr)  pgm_read_byte_far(((long)(page) << 16) | (unsigned)(addr))
+#endif
 
 #define macro   .macro
 #define endm    .endm